@@ -0,0 +1,149 @@
+#ifndef BINARYSTREAM_H
+#define BINARYSTREAM_H
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cassert>
+#include <type_traits>
+
+// == BINARY STREAMS ==
+// little helpers that append to / read from a flat byte buffer
+// (values are stored in native byte order, snapshots are not meant to move between architectures)
+class BinaryWriter
+{
+private:
+std::vector<char>& mBuffer;
+
+public:
+BinaryWriter(std::vector<char>& buffer) : mBuffer{buffer} {}
+
+void writeBytes(const void* src, std::size_t count)
+{
+    if(count == 0u) return;
+    auto offset{mBuffer.size()};
+    mBuffer.resize(offset + count);
+    std::memcpy(mBuffer.data() + offset, src, count);
+}
+
+template<typename T> void write(const T& value)
+{
+    static_assert(std::is_trivially_copyable<T>::value && "ERROR: only trivially copyable values can be written raw.");
+    writeBytes(&value, sizeof(T));
+}
+
+// LEB128: 7 bits per byte, small values take a single byte
+void writeVarint(std::uint64_t value)
+{
+    while(value >= 0x80u)
+    {
+        write(static_cast<std::uint8_t>(value | 0x80u));
+        value >>= 7;
+    }
+    write(static_cast<std::uint8_t>(value));
+}
+
+// signed values are zigzag encoded first so small negatives stay small
+void writeSignedVarint(std::int64_t value)
+{
+    writeVarint((static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+}
+
+void writeString(const std::string& str)
+{
+    write(static_cast<std::uint32_t>(str.size()));
+    writeBytes(str.data(), str.size());
+}
+
+// overwrite a value that was written earlier (e.g. a count only known afterwards)
+template<typename T> void patch(std::size_t offset, const T& value)
+{
+    assert(offset + sizeof(T) <= mBuffer.size() && "ERROR: patch outside of written data.");
+    std::memcpy(mBuffer.data() + offset, &value, sizeof(T));
+}
+
+// pad with zeroes up to the next multiple of 'alignment'
+void align(std::size_t alignment)
+{
+    auto padding{(alignment - mBuffer.size() % alignment) % alignment};
+    mBuffer.resize(mBuffer.size() + padding, 0);
+}
+
+std::size_t size() const noexcept { return mBuffer.size(); }
+};
+
+class BinaryReader
+{
+private:
+const char* mData;
+std::size_t mSize;
+std::size_t mOffset{0u};
+bool mFailed{false};
+
+public:
+BinaryReader(const char* data, std::size_t size) : mData{data}, mSize{size} {}
+
+// returns a pointer to the next 'count' bytes and advances past them
+// (nullptr, and the reader is marked as failed, if the buffer is too short)
+const char* skip(std::size_t count)
+{
+    if(mFailed || count > mSize - mOffset)
+    {
+        mFailed = true;
+        return nullptr;
+    }
+    const char* ptr{mData + mOffset};
+    mOffset += count;
+    return ptr;
+}
+
+bool readBytes(void* dst, std::size_t count)
+{
+    const char* src{skip(count)};
+    if(src == nullptr) return false;
+    if(count != 0u) std::memcpy(dst, src, count);
+    return true;
+}
+
+template<typename T> T read()
+{
+    static_assert(std::is_trivially_copyable<T>::value && "ERROR: only trivially copyable values can be read raw.");
+    T value{};
+    readBytes(&value, sizeof(T));
+    return value;
+}
+
+std::uint64_t readVarint()
+{
+    std::uint64_t value{0u};
+    for(unsigned shift{0u}; shift < 64u; shift += 7u)
+    {
+        auto byte{read<std::uint8_t>()};
+        value |= static_cast<std::uint64_t>(byte & 0x7Fu) << shift;
+        if((byte & 0x80u) == 0u || mFailed) return value;
+    }
+    mFailed = true;
+    return 0u;
+}
+
+std::int64_t readSignedVarint()
+{
+    auto value{readVarint()};
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1u);
+}
+
+std::string readString()
+{
+    auto length{read<std::uint32_t>()};
+    const char* src{skip(length)};
+    return src == nullptr ? std::string{} : std::string(src, length);
+}
+
+void setFailed() noexcept { mFailed = true; }
+bool failed() const noexcept { return mFailed; }
+std::size_t offset() const noexcept { return mOffset; }
+std::size_t remaining() const noexcept { return mSize - mOffset; }
+};
+
+#endif // BINARYSTREAM_H
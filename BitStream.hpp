@@ -0,0 +1,248 @@
+#ifndef BITSTREAM_H
+#define BITSTREAM_H
+
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <SFML/Network/Packet.hpp>
+
+// == QUANTIZATION ==
+// a float in [min, max] becomes an integer in [0, 2^bits - 1] (values outside are clamped)
+inline std::uint32_t quantizeFloat(float value, float min, float max, unsigned bits)
+{
+    assert(bits > 0u && bits <= 32u && max > min && "ERROR: invalid quantization range.");
+    double steps{static_cast<double>((std::uint64_t{1} << bits) - 1u)};
+    double t{(static_cast<double>(std::min(std::max(value, min), max)) - min) / (static_cast<double>(max) - min)};
+    return static_cast<std::uint32_t>(t * steps + 0.5);
+}
+
+inline float dequantizeFloat(std::uint32_t value, float min, float max, unsigned bits)
+{
+    double steps{static_cast<double>((std::uint64_t{1} << bits) - 1u)};
+    return static_cast<float>(min + (static_cast<double>(max) - min) * (static_cast<double>(value) / steps));
+}
+
+// fixed set of colors, a color is sent as the index of its nearest entry
+class ColorPalette
+{
+private:
+std::vector<sf::Color> mColors {};
+unsigned mBits{0u};
+
+public:
+ColorPalette() {}
+ColorPalette(std::vector<sf::Color> colors) : mColors{std::move(colors)}
+{
+    assert(!mColors.empty() && "ERROR: empty color palette.");
+    while((std::size_t{1} << mBits) < mColors.size()) ++mBits;
+}
+
+std::uint32_t indexOf(const sf::Color& color) const noexcept
+{
+    std::uint32_t best{0u};
+    int bestDistance{-1};
+    for(std::uint32_t i{0u}; i < mColors.size(); ++i)
+    {
+        int dr{mColors[i].r - color.r};
+        int dg{mColors[i].g - color.g};
+        int db{mColors[i].b - color.b};
+        int da{mColors[i].a - color.a};
+        int distance{dr * dr + dg * dg + db * db + da * da};
+        if(bestDistance < 0 || distance < bestDistance)
+        {
+            best = i;
+            bestDistance = distance;
+        }
+    }
+    return best;
+}
+
+const sf::Color& operator[](std::size_t i) const { return mColors[i]; }
+std::size_t size() const noexcept { return mColors.size(); }
+unsigned getBits() const noexcept { return mBits; }
+};
+
+
+// == BIT STREAMS ==
+// like BinaryWriter/BinaryReader, but values take only as many bits as they need
+// bits are filled LSB first; call flush() before the buffer is used
+class BitWriter
+{
+private:
+std::vector<char>& mBuffer;
+std::uint64_t mScratch{0u};
+unsigned mScratchBits{0u};
+std::size_t mBitCount{0u};
+
+public:
+BitWriter(std::vector<char>& buffer) : mBuffer{buffer} {}
+
+void writeBits(std::uint32_t value, unsigned count)
+{
+    assert(count <= 32u && "ERROR: at most 32 bits at once.");
+    if(count == 0u) return;
+
+    value &= static_cast<std::uint32_t>((std::uint64_t{1} << count) - 1u);
+    mScratch |= static_cast<std::uint64_t>(value) << mScratchBits;
+    mScratchBits += count;
+    mBitCount += count;
+    while(mScratchBits >= 8u)
+    {
+        mBuffer.emplace_back(static_cast<char>(mScratch & 0xFFu));
+        mScratch >>= 8;
+        mScratchBits -= 8u;
+    }
+}
+
+void writeBool(bool value) { writeBits(value ? 1u : 0u, 1u); }
+
+// 7 bits per group plus a continuation bit, small values (entity id deltas, counts) stay small
+void writeVarint(std::uint64_t value)
+{
+    while(value >= 0x80u)
+    {
+        writeBits(static_cast<std::uint32_t>(value & 0x7Fu) | 0x80u, 8u);
+        value >>= 7;
+    }
+    writeBits(static_cast<std::uint32_t>(value), 8u);
+}
+
+void writeBytes(const void* src, std::size_t count)
+{
+    auto* bytes{static_cast<const unsigned char*>(src)};
+    for(std::size_t i{0u}; i < count; ++i) writeBits(bytes[i], 8u);
+}
+
+void writeFloat(float value, float min, float max, unsigned bits)
+{
+    writeBits(quantizeFloat(value, min, max, bits), bits);
+}
+
+// unit vector as its angle
+void writeNormal(sf::Vector2f normal, unsigned bits)
+{
+    writeFloat(std::atan2(normal.y, normal.x), -3.14159265f, 3.14159265f, bits);
+}
+
+void writeColor(const sf::Color& color, const ColorPalette& palette)
+{
+    writeBits(palette.indexOf(color), palette.getBits());
+}
+
+// pad the last byte with zeroes
+void flush()
+{
+    if(mScratchBits == 0u) return;
+    mBuffer.emplace_back(static_cast<char>(mScratch & 0xFFu));
+    mBitCount += 8u - mScratchBits;
+    mScratch = 0u;
+    mScratchBits = 0u;
+}
+
+std::size_t bitCount() const noexcept { return mBitCount; }
+
+// flushes, then hands the bytes to an sf::Packet
+void appendTo(sf::Packet& packet)
+{
+    flush();
+    if(!mBuffer.empty()) packet.append(mBuffer.data(), mBuffer.size());
+}
+};
+
+class BitReader
+{
+private:
+const unsigned char* mData;
+std::size_t mSize;
+std::size_t mBitOffset{0u};
+bool mFailed{false};
+
+public:
+BitReader(const char* data, std::size_t size) : mData{reinterpret_cast<const unsigned char*>(data)}, mSize{size} {}
+BitReader(const sf::Packet& packet) : BitReader{static_cast<const char*>(packet.getData()), packet.getDataSize()} {}
+
+std::uint32_t readBits(unsigned count)
+{
+    assert(count <= 32u && "ERROR: at most 32 bits at once.");
+    if(mFailed || count > mSize * 8u - mBitOffset)
+    {
+        mFailed = true;
+        return 0u;
+    }
+
+    std::uint64_t value{0u};
+    unsigned done{0u};
+    while(done < count)
+    {
+        auto byte{mBitOffset / 8u};
+        auto shift{static_cast<unsigned>(mBitOffset % 8u)};
+        auto take{std::min(8u - shift, count - done)};
+        std::uint64_t bits{(static_cast<std::uint64_t>(mData[byte]) >> shift) & ((1u << take) - 1u)};
+        value |= bits << done;
+        done += take;
+        mBitOffset += take;
+    }
+    return static_cast<std::uint32_t>(value);
+}
+
+bool readBool() { return readBits(1u) != 0u; }
+
+std::uint64_t readVarint()
+{
+    std::uint64_t value{0u};
+    for(unsigned shift{0u}; shift < 64u; shift += 7u)
+    {
+        auto group{readBits(8u)};
+        value |= static_cast<std::uint64_t>(group & 0x7Fu) << shift;
+        if((group & 0x80u) == 0u || mFailed) return value;
+    }
+    mFailed = true;
+    return 0u;
+}
+
+bool readBytes(void* dst, std::size_t count)
+{
+    if(count > remainingBits() / 8u)
+    {
+        mFailed = true;
+        return false;
+    }
+    auto* bytes{static_cast<unsigned char*>(dst)};
+    for(std::size_t i{0u}; i < count; ++i) bytes[i] = static_cast<unsigned char>(readBits(8u));
+    return true;
+}
+
+float readFloat(float min, float max, unsigned bits)
+{
+    return dequantizeFloat(readBits(bits), min, max, bits);
+}
+
+sf::Vector2f readNormal(unsigned bits)
+{
+    float angle{readFloat(-3.14159265f, 3.14159265f, bits)};
+    return sf::Vector2f{std::cos(angle), std::sin(angle)};
+}
+
+sf::Color readColor(const ColorPalette& palette)
+{
+    auto index{readBits(palette.getBits())};
+    if(index >= palette.size())
+    {
+        mFailed = true;
+        return sf::Color{};
+    }
+    return palette[index];
+}
+
+void setFailed() noexcept { mFailed = true; }
+bool failed() const noexcept { return mFailed; }
+std::size_t remainingBits() const noexcept { return mSize * 8u - mBitOffset; }
+};
+
+#endif // BITSTREAM_H
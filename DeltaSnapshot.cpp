@@ -0,0 +1,346 @@
+#include "DeltaSnapshot.hpp"
+
+#include <fstream>
+
+constexpr std::uint32_t deltaSnapshotMagic{0x444C4F56u}; // "VOLD"
+constexpr std::uint32_t deltaSnapshotVersion{3u};
+
+// how a column is stored in a delta
+enum DeltaColumnMode : std::uint8_t
+{
+    DeltaUnchanged,  // only the (possibly shrunk) length
+    DeltaChunks,     // [chunk index, owners, data] for every changed chunk
+    DeltaWhole       // owners + serialized column
+};
+
+// == WRITER ==
+void DeltaSnapshotWriter::writeBase(EntityManager& manager, const SnapshotRegistry& registry, std::vector<char>& buffer)
+{
+    this->write(manager, registry, buffer, true);
+}
+
+void DeltaSnapshotWriter::writeDelta(EntityManager& manager, const SnapshotRegistry& registry, std::vector<char>& buffer)
+{
+    this->write(manager, registry, buffer, !this->mHasBase);
+}
+
+void DeltaSnapshotWriter::write(EntityManager& manager, const SnapshotRegistry& registry, std::vector<char>& buffer, bool base)
+{
+    buffer.clear();
+    BinaryWriter out{buffer};
+    auto& entries{registry.getEntries()};
+
+    // a base treats everything as changed
+    auto since{base ? 0u : this->mCheckpointTick};
+    auto parent{this->mSequence};
+    ++this->mSequence;
+
+    // 1. manifest: header + type table
+    out.write(deltaSnapshotMagic);
+    out.write(deltaSnapshotVersion);
+    out.write(static_cast<std::uint32_t>(BaseComponentPool::chunkSize));
+    out.write(this->mSequence);
+    out.write(parent);
+    out.write(static_cast<std::uint8_t>(base));
+
+    bool hasHeapTypes{false};
+    out.write(static_cast<std::uint32_t>(entries.size()));
+    for(auto& entry : entries)
+    {
+        out.writeString(entry.mName);
+        out.write(entry.getKind());
+        out.write(entry.mRawSize);
+        hasHeapTypes = hasHeapTypes || entry.getKind() == SnapshotHeapType;
+    }
+
+    // 2. entity table, only if the set of entities or their groups changed
+    auto& entities{manager.getEntities()};
+    bool writeEntities{base || manager.getStructureTick() > since};
+    out.write(static_cast<std::uint8_t>(writeEntities));
+    if(writeEntities)
+    {
+        out.write(static_cast<std::uint32_t>(entities.size()));
+        for(auto& entity : entities) out.write(entity->getID());
+        for(auto& entity : entities) out.write(static_cast<std::uint32_t>(entity->getGroups().to_ulong()));
+    }
+
+    auto& masks{this->mMaskScratch};
+    masks.clear();
+    for(auto& entity : entities) masks.emplace_back(registry.getTagMask(*entity));
+    for(auto& entity : entities) masks.emplace_back(registry.getDisabledMask(*entity));
+    bool writeMasks{writeEntities || masks != this->mEntityMasks};
+    out.write(static_cast<std::uint8_t>(writeMasks));
+    if(writeMasks)
+    {
+        out.writeBytes(masks.data(), masks.size() * sizeof(std::uint32_t));
+        std::swap(masks, this->mEntityMasks);
+    }
+
+    // 3. heap components, no change tracking so they are rewritten whole
+    out.write(static_cast<std::uint8_t>(hasHeapTypes));
+    if(hasHeapTypes)
+    {
+        auto sizeOffset{out.size()};
+        out.write(std::uint64_t{0u});
+        for(auto& entity : entities) writeHeapComponents(*entity, registry, out);
+        out.patch(sizeOffset, static_cast<std::uint64_t>(out.size() - sizeOffset - sizeof(std::uint64_t)));
+    }
+
+    // 4. pooled columns
+    if(base) this->mColumnCounts.assign(entries.size(), 0u);
+    this->mColumnCounts.resize(entries.size(), 0u);
+    for(std::size_t i{0u}; i < entries.size(); ++i)
+    {
+        auto& entry{entries[i]};
+        if(!entry.mPooled) continue;
+
+        auto* pool{manager.getPool(entry.mTypeID)};
+        auto count{static_cast<std::uint64_t>(pool == nullptr ? 0u : pool->size())};
+        out.write(count);
+
+        std::vector<std::uint32_t> dirty;
+        for(std::size_t chunk{0u}; count != 0u && chunk < pool->getChunkCount(); ++chunk)
+        {
+            if(pool->getChunkTick(chunk) > since) dirty.emplace_back(static_cast<std::uint32_t>(chunk));
+        }
+
+        if(count == 0u || (dirty.empty() && (entry.mRawSize != 0u || count == this->mColumnCounts[i])))
+        {
+            out.write(static_cast<std::uint8_t>(DeltaUnchanged));
+        }
+        else if(entry.mRawSize != 0u && !base)
+        {
+            // only the changed chunks of the owner/data columns
+            auto* owners{pool->owners()};
+            auto* data{static_cast<const char*>(pool->rawData())};
+
+            out.write(static_cast<std::uint8_t>(DeltaChunks));
+            out.write(static_cast<std::uint32_t>(dirty.size()));
+            for(auto chunk : dirty)
+            {
+                auto first{chunk * BaseComponentPool::chunkSize};
+                auto length{std::min<std::size_t>(BaseComponentPool::chunkSize, pool->size() - first)};
+                out.write(chunk);
+                out.writeBytes(owners + first, length * sizeof(EntityID));
+                out.writeBytes(data + first * entry.mRawSize, length * entry.mRawSize);
+            }
+        }
+        else
+        {
+            out.write(static_cast<std::uint8_t>(DeltaWhole));
+            out.writeBytes(pool->owners(), pool->size() * sizeof(EntityID));
+
+            auto sizeOffset{out.size()};
+            out.write(std::uint64_t{0u});
+            entry.writeColumn(*pool, out);
+            out.patch(sizeOffset, static_cast<std::uint64_t>(out.size() - sizeOffset - sizeof(std::uint64_t)));
+        }
+        this->mColumnCounts[i] = count;
+    }
+
+    // 5. checkpoint: changes from now on compare greater than this tick
+    this->mCheckpointTick = manager.getChangeTick();
+    manager.advanceChangeTick();
+    this->mHasBase = true;
+}
+
+// == CHAIN ==
+bool SnapshotChain::apply(const char* data, std::size_t size)
+{
+    BinaryReader in{data, size};
+
+    // 1. manifest
+    if(in.read<std::uint32_t>() != deltaSnapshotMagic || in.read<std::uint32_t>() != deltaSnapshotVersion
+    || in.read<std::uint32_t>() != BaseComponentPool::chunkSize)
+    {
+        std::cerr << "ERROR: not a delta snapshot, or written by an incompatible version." << std::endl;
+        return false;
+    }
+
+    auto sequence{in.read<std::uint32_t>()};
+    auto parent{in.read<std::uint32_t>()};
+    bool base{in.read<std::uint8_t>() != 0u};
+    if(!base && (!this->mHasBase || parent != this->mSequence))
+    {
+        std::cerr << "ERROR: delta " << sequence << " does not follow snapshot " << this->mSequence << "." << std::endl;
+        return false;
+    }
+
+    auto typeCount{in.read<std::uint32_t>()};
+    if(typeCount > in.remaining()) return false;
+    std::vector<TypeInfo> types(typeCount);
+    for(auto& type : types)
+    {
+        type.mName = in.readString();
+        type.mKind = in.read<std::uint8_t>();
+        type.mRawSize = in.read<std::uint32_t>();
+    }
+    if(in.failed()) return false;
+
+    if(!base)
+    {
+        bool sameTypes{types.size() == this->mTypes.size()};
+        for(std::size_t i{0u}; sameTypes && i < types.size(); ++i)
+        {
+            sameTypes = types[i].mName == this->mTypes[i].mName && types[i].mKind == this->mTypes[i].mKind
+                     && types[i].mRawSize == this->mTypes[i].mRawSize;
+        }
+        if(!sameTypes)
+        {
+            std::cerr << "ERROR: delta " << sequence << " was written with different component types." << std::endl;
+            return false;
+        }
+    }
+
+    // 2. decode in place (a corrupt delta invalidates the chain, a new base is needed after that)
+    if(base)
+    {
+        this->mTypes = std::move(types);
+        this->mEntityIDs.clear();
+        this->mEntityGroups.clear();
+        this->mEntityTags.clear();
+        this->mEntityDisabled.clear();
+        this->mHeap.clear();
+        this->mColumns.assign(this->mTypes.size(), Column{});
+    }
+    this->mHasBase = false;
+
+    if(in.read<std::uint8_t>() != 0u)
+    {
+        auto count{in.read<std::uint32_t>()};
+        if(count > in.remaining() / (sizeof(EntityID) + sizeof(std::uint32_t))) in.setFailed();
+        else
+        {
+            this->mEntityIDs.resize(count);
+            this->mEntityGroups.resize(count);
+            in.readBytes(this->mEntityIDs.data(), count * sizeof(EntityID));
+            in.readBytes(this->mEntityGroups.data(), count * sizeof(std::uint32_t));
+        }
+    }
+
+    // tag then disabled masks, one each per entity of the (possibly just replaced) entity table
+    if(in.read<std::uint8_t>() != 0u)
+    {
+        this->mEntityTags.resize(this->mEntityIDs.size());
+        this->mEntityDisabled.resize(this->mEntityIDs.size());
+        in.readBytes(this->mEntityTags.data(), this->mEntityTags.size() * sizeof(std::uint32_t));
+        in.readBytes(this->mEntityDisabled.data(), this->mEntityDisabled.size() * sizeof(std::uint32_t));
+    }
+    else if(this->mEntityTags.size() != this->mEntityIDs.size()) in.setFailed();
+
+    if(in.read<std::uint8_t>() != 0u)
+    {
+        auto heapSize{in.read<std::uint64_t>()};
+        if(heapSize > in.remaining()) in.setFailed();
+        else
+        {
+            this->mHeap.resize(static_cast<std::size_t>(heapSize));
+            in.readBytes(this->mHeap.data(), this->mHeap.size());
+        }
+    }
+
+    for(std::size_t i{0u}; i < this->mTypes.size() && !in.failed(); ++i)
+    {
+        auto& type{this->mTypes[i]};
+        auto& column{this->mColumns[i]};
+        if(type.mKind != SnapshotPooledType) continue;
+
+        auto count{in.read<std::uint64_t>()};
+        auto mode{in.read<std::uint8_t>()};
+        if(count > column.mOwners.size() + in.remaining() / sizeof(EntityID))
+        {
+            in.setFailed();
+            break;
+        }
+
+        if(mode == DeltaWhole)
+        {
+            column.mOwners.resize(static_cast<std::size_t>(count));
+            in.readBytes(column.mOwners.data(), column.mOwners.size() * sizeof(EntityID));
+            auto dataSize{in.read<std::uint64_t>()};
+            if(dataSize > in.remaining() || (type.mRawSize != 0u && dataSize != count * type.mRawSize))
+            {
+                in.setFailed();
+                break;
+            }
+            column.mData.resize(static_cast<std::size_t>(dataSize));
+            in.readBytes(column.mData.data(), column.mData.size());
+            continue;
+        }
+
+        // unchanged/chunked columns keep their data, bar a change in length
+        // (serialized columns can only be replaced whole)
+        if(type.mRawSize == 0u || (mode != DeltaUnchanged && mode != DeltaChunks))
+        {
+            if(mode != DeltaUnchanged || count != column.mOwners.size()) in.setFailed();
+            continue;
+        }
+        column.mOwners.resize(static_cast<std::size_t>(count));
+        column.mData.resize(static_cast<std::size_t>(count) * type.mRawSize);
+        if(mode == DeltaUnchanged) continue;
+
+        auto chunkCount{in.read<std::uint32_t>()};
+        for(std::uint32_t c{0u}; c < chunkCount && !in.failed(); ++c)
+        {
+            auto first{static_cast<std::size_t>(in.read<std::uint32_t>()) * BaseComponentPool::chunkSize};
+            if(first >= count)
+            {
+                in.setFailed();
+                break;
+            }
+
+            auto length{std::min<std::size_t>(BaseComponentPool::chunkSize, static_cast<std::size_t>(count) - first)};
+            in.readBytes(column.mOwners.data() + first, length * sizeof(EntityID));
+            in.readBytes(column.mData.data() + first * type.mRawSize, length * type.mRawSize);
+        }
+    }
+
+    if(in.failed())
+    {
+        std::cerr << "ERROR: delta snapshot is truncated or corrupt, the chain needs a new base." << std::endl;
+        return false;
+    }
+
+    this->mSequence = sequence;
+    this->mHasBase = true;
+    return true;
+}
+
+bool SnapshotChain::applyFile(const std::string& path)
+{
+    std::ifstream file{path, std::ios::binary | std::ios::ate};
+    if(!file)
+    {
+        std::cerr << "ERROR: could not open snapshot '" << path << "'." << std::endl;
+        return false;
+    }
+
+    std::vector<char> buffer(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    return file && this->apply(buffer.data(), buffer.size());
+}
+
+bool SnapshotChain::loadInto(EntityManager& manager, const SnapshotRegistry& registry) const
+{
+    if(!this->mHasBase) return false;
+
+    std::vector<const SnapshotRegistry::Entry*> types(this->mTypes.size(), nullptr);
+    std::vector<SnapshotColumnParts> columns(this->mTypes.size(), SnapshotColumnParts{nullptr, 0u, nullptr, 0u});
+    for(std::size_t i{0u}; i < this->mTypes.size(); ++i)
+    {
+        auto& type{this->mTypes[i]};
+        types[i] = resolveSnapshotType(registry, type.mName, type.mKind, type.mRawSize);
+        if(types[i] == nullptr) return false;
+
+        auto& column{this->mColumns[i]};
+        columns[i] = SnapshotColumnParts{reinterpret_cast<const char*>(column.mOwners.data()), column.mOwners.size(),
+                                         column.mData.data(), column.mData.size()};
+    }
+
+    bool ok{loadSnapshotParts(manager, types, this->mEntityIDs.data(), this->mEntityGroups.data(), this->mEntityTags.data(),
+                              this->mEntityDisabled.data(), this->mEntityIDs.size(),
+                              this->mHeap.data(), this->mHeap.size(), columns)};
+    if(!ok) std::cerr << "ERROR: delta snapshot chain does not form a valid world." << std::endl;
+    return ok;
+}
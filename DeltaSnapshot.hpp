@@ -0,0 +1,79 @@
+#ifndef DELTASNAPSHOT_H
+#define DELTASNAPSHOT_H
+
+#include "Snapshot.hpp"
+
+// == DELTA SNAPSHOTS ==
+// a chain of one base snapshot followed by deltas, each delta only holding what changed since
+// the previous checkpoint:
+// - pooled columns: the chunks (BaseComponentPool::chunkSize elements) stamped since the checkpoint,
+//   plus the column length (non trivially copyable columns are rewritten whole once any chunk changed)
+// - entity ids/groups: only if an entity was created/destroyed or changed groups
+// - entity tag masks: only if the entity table was written or any tag changed
+// - heap components: always rewritten (they have no change tracking), omitted when none are registered
+// every delta carries its sequence number and the one it applies on top of, so gaps are detected
+
+class DeltaSnapshotWriter
+{
+private:
+std::uint32_t mSequence{0u};
+std::uint32_t mCheckpointTick{0u};
+bool mHasBase{false};
+// column lengths at the last checkpoint (serialized columns are rewritten when they change)
+std::vector<std::uint64_t> mColumnCounts {};
+// tag masks then disabled masks at the last checkpoint (neither moves the structure tick, so they are compared)
+std::vector<std::uint32_t> mEntityMasks {};
+std::vector<std::uint32_t> mMaskScratch {};
+
+void write(EntityManager& manager, const SnapshotRegistry& registry, std::vector<char>& buffer, bool base);
+
+public:
+// full save, starts a new chain
+void writeBase(EntityManager& manager, const SnapshotRegistry& registry, std::vector<char>& buffer);
+// everything changed since the previous base/delta (falls back to a base if there is none yet)
+void writeDelta(EntityManager& manager, const SnapshotRegistry& registry, std::vector<char>& buffer);
+
+std::uint32_t getSequence() const noexcept { return mSequence; }
+};
+
+// rebuilds the full state by applying a base and its deltas in order
+class SnapshotChain
+{
+private:
+struct TypeInfo
+{
+    std::string mName;
+    std::uint8_t mKind;     // SnapshotTypeKind
+    std::uint32_t mRawSize;
+};
+
+struct Column
+{
+    std::vector<EntityID> mOwners {};
+    std::vector<char> mData {};
+};
+
+std::vector<TypeInfo> mTypes {};
+std::vector<EntityID> mEntityIDs {};
+std::vector<std::uint32_t> mEntityGroups {};
+std::vector<std::uint32_t> mEntityTags {};
+std::vector<std::uint32_t> mEntityDisabled {};
+std::vector<char> mHeap {};
+std::vector<Column> mColumns {};
+std::uint32_t mSequence{0u};
+bool mHasBase{false};
+
+public:
+// apply a base (resets the chain) or the delta following the last applied one
+// a delta that fails part way leaves the chain unusable until the next base
+bool apply(const char* data, std::size_t size);
+bool applyFile(const std::string& path);
+
+// load the reconstructed state into a manager (clears it first)
+bool loadInto(EntityManager& manager, const SnapshotRegistry& registry) const;
+
+bool hasBase() const noexcept { return mHasBase; }
+std::uint32_t getSequence() const noexcept { return mSequence; }
+};
+
+#endif // DELTASNAPSHOT_H
@@ -0,0 +1,2446 @@
+#ifndef ECS_H
+#define ECS_H
+
+#include <iostream>
+#include <vector>
+#include <array>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <bitset>
+#include <cassert>
+#include <type_traits>
+#include <functional>
+#include <unordered_map>
+#include <deque>
+#include <cstring>
+#include <atomic>
+#include <tuple>
+#include <utility>
+
+#include <SFML/Graphics.hpp>
+
+class Component;
+class EntityManager;
+class Entity;
+template<typename... Ts> class Query;
+template<typename... Ts> class OwningGroup;
+
+
+// == ENTITY ID SYSTEM ==
+// an EntityID packs the entity's slot index (low bits) and a version (high bits)
+// the version is bumped whenever a slot is recycled, so stale ids kept around
+// (in snapshots, other components, ...) never resolve to the wrong entity
+using EntityID = std::uint32_t;
+constexpr std::uint32_t entityIndexBits{22};
+constexpr EntityID entityIndexMask{(EntityID{1} << entityIndexBits) - 1u};
+constexpr std::uint32_t entityVersionMask{(std::uint32_t{1} << (32u - entityIndexBits)) - 1u};
+constexpr EntityID nullEntity{~EntityID{0}};
+
+constexpr std::uint32_t getEntityIndex(EntityID id) noexcept
+{
+    return id & entityIndexMask;
+}
+
+constexpr std::uint32_t getEntityVersion(EntityID id) noexcept
+{
+    return id >> entityIndexBits;
+}
+
+constexpr EntityID makeEntityID(std::uint32_t index, std::uint32_t version) noexcept
+{
+    return ((version & entityVersionMask) << entityIndexBits) | (index & entityIndexMask);
+}
+
+
+// == COMPONENT ID SYSTEM ==
+using ComponentID = std::uint32_t;
+constexpr std::size_t maxComponents{32};
+
+// == group variables ==
+using GroupID = std::uint32_t;
+constexpr std::uint32_t maxGroups{32};
+using GroupBitset = std::bitset<maxGroups>;
+
+using ComponentBitset = std::bitset<maxComponents>;
+using ComponentArray = std::array<Component*, maxComponents>;
+
+// == OBSERVER EVENTS ==
+// what happened to a component, see EntityManager::observe()
+enum class ObserverEvent : std::uint8_t
+{
+    Add,
+    Set,
+    Remove
+};
+constexpr std::size_t observerEventCount{3};
+
+// components come in two flavours:
+// - classes inheriting from Component live on the heap and receive virtual update/render calls
+// - any other (plain data) type is stored contiguously in a ComponentPool owned by the manager
+//   empty ones are tags: they only set their signature bit and have no pool at all
+template<typename T> constexpr bool isPooledComponent{!std::is_base_of<Component, T>::value};
+template<typename T> constexpr bool isTagComponent{isPooledComponent<T> && std::is_empty<T>::value};
+
+// all tags of a type are alike, accessors hand out this one
+template<typename T> T& getTagInstance() noexcept
+{
+    static T tag{};
+    return tag;
+}
+
+inline ComponentID genUComponentID() noexcept
+{
+    // generate a unique id for a component
+    // (this gets called in the getComponentTypeID function -> when Entity::addComponent() is called)
+    // (atomic, so worlds can be filled from several threads)
+    static std::atomic<ComponentID> lastID{0u};
+    return lastID++;
+}
+
+template<typename T> inline ComponentID getComponentTypeID() noexcept
+{
+    // for each unique component type, the template will be instanciated
+    // only once for each type of component thus, creating a unique ID
+    // (heap components and pooled components share the same ID space / signature bits)
+    static ComponentID typeID{genUComponentID()};
+    assert(typeID < maxComponents && "ERROR: too many component types, raise maxComponents.");
+
+    // subsequent calls with the same component type will return the same ID
+    return typeID;
+}
+
+
+// == RELATIONS ==
+// directed pairs between entities: the source has (at most) one target per kind,
+// a target knows all of its sources, see EntityManager::relate()
+enum class Relation : std::uint8_t
+{
+    ChildOf,
+    Targets,
+    OwnedBy
+};
+constexpr std::size_t relationCount{3};
+
+// contiguous run of entity ids (valid until the next structural change)
+struct EntityRange
+{
+    const EntityID* mBegin{nullptr};
+    const EntityID* mEnd{nullptr};
+
+    const EntityID* begin() const noexcept { return mBegin; }
+    const EntityID* end() const noexcept { return mEnd; }
+    std::size_t size() const noexcept { return static_cast<std::size_t>(mEnd - mBegin); }
+    bool empty() const noexcept { return mBegin == mEnd; }
+};
+
+// contiguous run of events handed to an event handler (valid for the duration of the call)
+template<typename T>
+struct EventSpan
+{
+    const T* mBegin{nullptr};
+    const T* mEnd{nullptr};
+
+    const T* begin() const noexcept { return mBegin; }
+    const T* end() const noexcept { return mEnd; }
+    const T* data() const noexcept { return mBegin; }
+    const T& operator[](std::size_t i) const noexcept { return mBegin[i]; }
+    std::size_t size() const noexcept { return static_cast<std::size_t>(mEnd - mBegin); }
+    bool empty() const noexcept { return mBegin == mEnd; }
+};
+
+
+// == RESOURCE ID SYSTEM ==
+// resources are typed singletons owned by the manager (see EntityManager::resource)
+// they have an id space of their own, independent of component ids
+using ResourceID = std::uint32_t;
+constexpr std::size_t maxResources{32};
+using ResourceBitset = std::bitset<maxResources>;
+
+inline ResourceID genUResourceID() noexcept
+{
+    static std::atomic<ResourceID> lastID{0u};
+    return lastID++;
+}
+
+template<typename T> inline ResourceID getResourceTypeID() noexcept
+{
+    static ResourceID typeID{genUResourceID()};
+    assert(typeID < maxResources && "ERROR: too many resource types, raise maxResources.");
+    return typeID;
+}
+
+// == EVENT ID SYSTEM ==
+// event types (collisions, damage, ...) get their own id space too (see EntityManager::emit)
+using EventID = std::uint32_t;
+constexpr std::size_t maxEventTypes{32};
+
+inline EventID genUEventID() noexcept
+{
+    static std::atomic<EventID> lastID{0u};
+    return lastID++;
+}
+
+template<typename T> inline EventID getEventTypeID() noexcept
+{
+    static EventID typeID{genUEventID()};
+    assert(typeID < maxEventTypes && "ERROR: too many event types, raise maxEventTypes.");
+    return typeID;
+}
+
+
+// == SYSTEM ACCESS ==
+// the components and resources a system reads and writes, declared up front so
+// a scheduler can tell which systems may run side by side
+// while one is active (ScopedSystemAccess), resource accesses are checked against it
+struct SystemAccess
+{
+    ComponentBitset mReadComponents {};
+    ComponentBitset mWriteComponents {};
+    ResourceBitset mReadResources {};
+    ResourceBitset mWriteResources {};
+
+    template<typename T> SystemAccess& reads() { mReadComponents.set(getComponentTypeID<T>()); return *this; }
+    template<typename T> SystemAccess& writes() { mWriteComponents.set(getComponentTypeID<T>()); return *this; }
+    template<typename T> SystemAccess& readsResource() { mReadResources.set(getResourceTypeID<T>()); return *this; }
+    template<typename T> SystemAccess& writesResource() { mWriteResources.set(getResourceTypeID<T>()); return *this; }
+
+    // true if the two can not run at the same time (one writes what the other touches)
+    bool conflictsWith(const SystemAccess& other) const noexcept
+    {
+        auto components{(mWriteComponents & (other.mReadComponents | other.mWriteComponents))
+                      | (other.mWriteComponents & mReadComponents)};
+        auto resources{(mWriteResources & (other.mReadResources | other.mWriteResources))
+                     | (other.mWriteResources & mReadResources)};
+        return components.any() || resources.any();
+    }
+};
+
+
+// == SHARED COMPONENTS ==
+// flyweights: each distinct value of T is stored once by the manager, entities hold a
+// Shared<T> handle to it (a 4 byte pooled component, so it works in queries, prefabs, ...)
+// shared values are immutable and live until the manager is cleared (see EntityManager::share)
+// handles only mean something to the manager that made them, so they can not be saved in
+// snapshots, rolled back or replicated (those reject Shared<T> types)
+// like entity ids a handle packs an index with a generation: clear() starts a new generation, so a
+// handle kept from before (e.g. in a prefab) is caught by getShared() instead of resolving to another value
+constexpr std::uint32_t sharedIndexBits{20};
+constexpr std::uint32_t sharedIndexMask{(std::uint32_t{1} << sharedIndexBits) - 1u};
+constexpr std::uint32_t sharedGenerationMask{(std::uint32_t{1} << (32u - sharedIndexBits)) - 1u};
+
+template<typename T> struct Shared
+{
+    std::uint32_t mHandle{0u};
+
+    std::uint32_t getIndex() const noexcept { return mHandle & sharedIndexMask; }
+    std::uint32_t getGeneration() const noexcept { return mHandle >> sharedIndexBits; }
+};
+
+template<typename T> struct IsSharedComponent : std::false_type {};
+template<typename T> struct IsSharedComponent<Shared<T>> : std::true_type {};
+template<typename T> constexpr bool isSharedComponent{IsSharedComponent<T>::value};
+
+// how shared values are deduplicated, specialise for types that are not trivially copyable
+// or whose equal values may differ in their bytes (padding, floats: -0.0f == 0.0f)
+// (the default compares and hashes the raw bytes)
+template<typename T> struct SharedTraits
+{
+    static_assert(std::is_trivially_copyable<T>::value && "ERROR: specialise SharedTraits for this type.");
+    static_assert(std::has_unique_object_representations<T>::value && "ERROR: T has padding or float members, specialise SharedTraits for it.");
+
+    static std::size_t hash(const T& value) noexcept
+    {
+        // FNV-1a
+        auto* bytes{reinterpret_cast<const unsigned char*>(&value)};
+        std::uint64_t hash{14695981039346656037ull};
+        for(std::size_t i{0u}; i < sizeof(T); ++i) hash = (hash ^ bytes[i]) * 1099511628211ull;
+        return static_cast<std::size_t>(hash);
+    }
+
+    static bool equal(const T& a, const T& b) noexcept
+    {
+        return std::memcmp(&a, &b, sizeof(T)) == 0;
+    }
+};
+
+
+// == BASE COMPONENT CLASS ==
+class Component
+{
+public:
+Entity* mEntity{nullptr};
+ComponentID mTypeID{0u};
+
+// for any component that is dependant on other component types
+// (makes composition easiers)
+virtual void initComponent() {}
+
+Component() {}
+virtual ~Component() {}
+
+void setOwnership(Entity* eOwner)
+{
+    this->mEntity = eOwner;
+}
+
+virtual void updateComponent(const float& dt) {}
+virtual void renderComponent(sf::RenderWindow& targetWin) {}
+
+};
+
+
+// == COMPONENT POOLS ==
+// type-erased interface so the manager can clean up pools without knowing their type
+// it also does the change tracking: every chunk of 'chunkSize' elements remembers the
+// manager's change tick of its last mutable access (used by delta snapshots and changed<T>() queries),
+// every element the tick it was added at (added<T>() queries)
+class BaseComponentPool
+{
+public:
+static constexpr std::size_t chunkSize{256};
+static constexpr std::size_t noIndex{~std::size_t{0}};
+
+protected:
+std::vector<std::uint32_t> mChunkTicks {};
+std::vector<std::uint32_t> mAddedTicks {};     // parallel to the component column
+std::uint32_t mChangeTick{0u};
+
+void stampChunk(std::size_t pos) noexcept
+{
+    mChunkTicks[pos / chunkSize] = mChangeTick;
+}
+
+// keep one tick per (partially) used chunk
+void resizeChunks(std::size_t elementCount)
+{
+    mChunkTicks.resize((elementCount + chunkSize - 1u) / chunkSize, mChangeTick);
+}
+
+void stampAll() noexcept
+{
+    std::fill(mChunkTicks.begin(), mChunkTicks.end(), mChangeTick);
+}
+
+void stampRange(std::size_t first, std::size_t count) noexcept
+{
+    if(count == 0u) return;
+    std::fill(mChunkTicks.begin() + first / chunkSize, mChunkTicks.begin() + (first + count - 1u) / chunkSize + 1u, mChangeTick);
+}
+
+public:
+virtual ~BaseComponentPool() {}
+
+virtual bool contains(EntityID id) const noexcept = 0;
+virtual void remove(EntityID id) = 0;
+virtual void clear() = 0;
+
+virtual std::size_t size() const noexcept = 0;
+virtual const EntityID* owners() const noexcept = 0;
+// position of the entity's component in the column (noIndex if it has none)
+virtual std::size_t indexOf(EntityID id) const noexcept = 0;
+
+// exchange two elements (owning groups use this to keep their members at the front)
+virtual void swapElements(std::size_t a, std::size_t b) = 0;
+
+// == moving components between managers ==
+// an empty pool of the same type
+virtual BaseComponentPool* createEmpty() const = 0;
+// add a copy of the entity's component to 'destination' (same type), owned by 'newID'
+virtual void copyOne(EntityID id, BaseComponentPool& destination, EntityID newID) const = 0;
+// append the whole column to 'destination' (same type), owners translated through
+// newIDs (entity index in this pool's manager -> id in the destination's)
+virtual void mergeInto(BaseComponentPool& destination, const std::vector<EntityID>& newIDs) const = 0;
+// raw bytes of the component column (only meaningful for trivially copyable types)
+virtual const void* rawData() const noexcept = 0;
+
+void setChangeTick(std::uint32_t tick) noexcept { mChangeTick = tick; }
+std::size_t getChunkCount() const noexcept { return mChunkTicks.size(); }
+std::uint32_t getChunkTick(std::size_t chunk) const noexcept { return mChunkTicks[chunk]; }
+std::uint32_t getAddedTick(std::size_t pos) const noexcept { return mAddedTicks[pos]; }
+
+// for writes through raw pointers that bypassed the pool
+void markChanged(std::size_t pos) noexcept { stampChunk(pos); }
+};
+
+// densely packed storage for one plain data component type
+// (sparse set: entity index -> dense index, dense arrays hold data + owner ids in the same order)
+template<typename T>
+class ComponentPool : public BaseComponentPool
+{
+private:
+static constexpr std::uint32_t npos{~std::uint32_t{0}};
+
+std::vector<T> mDense {};               // the component column
+std::vector<EntityID> mOwners {};       // mOwners[i] owns mDense[i]
+std::vector<std::uint32_t> mSparse {};  // entity index -> position in mDense (npos if absent)
+
+public:
+template<typename... TArgs>
+T& emplace(EntityID id, TArgs&&... mArgs)
+{
+    assert(!contains(id) && "ERROR: entity already owns this component.");
+
+    auto index{getEntityIndex(id)};
+    if(index >= mSparse.size()) mSparse.resize(index + 1u, npos);
+
+    mSparse[index] = static_cast<std::uint32_t>(mDense.size());
+    mOwners.emplace_back(id);
+    mAddedTicks.emplace_back(mChangeTick);
+    resizeChunks(mOwners.size());
+    stampChunk(mOwners.size() - 1u);
+
+    // aggregates (plain structs without constructors) get brace-initialised
+    if constexpr(std::is_constructible<T, TArgs...>::value)
+    {
+        mDense.emplace_back(std::forward<TArgs>(mArgs)...);
+    }
+    else
+    {
+        mDense.emplace_back(T{std::forward<TArgs>(mArgs)...});
+    }
+    return mDense.back();
+}
+
+void remove(EntityID id) override
+{
+    if(!contains(id)) return;
+
+    // swap the last element into the hole so the column stays packed
+    auto pos{mSparse[getEntityIndex(id)]};
+    auto last{static_cast<std::uint32_t>(mDense.size() - 1u)};
+    if(pos != last)
+    {
+        mDense[pos] = std::move(mDense[last]);
+        mOwners[pos] = mOwners[last];
+        mAddedTicks[pos] = mAddedTicks[last];
+        mSparse[getEntityIndex(mOwners[pos])] = pos;
+        stampChunk(pos);
+    }
+    mDense.pop_back();
+    mOwners.pop_back();
+    mAddedTicks.pop_back();
+    mSparse[getEntityIndex(id)] = npos;
+    resizeChunks(mOwners.size());
+}
+
+bool contains(EntityID id) const noexcept override
+{
+    auto index{getEntityIndex(id)};
+    return index < mSparse.size() && mSparse[index] != npos && mOwners[mSparse[index]] == id;
+}
+
+std::size_t indexOf(EntityID id) const noexcept override
+{
+    return contains(id) ? mSparse[getEntityIndex(id)] : noIndex;
+}
+
+BaseComponentPool* createEmpty() const override { return new ComponentPool<T>{}; }
+
+void swapElements(std::size_t a, std::size_t b) override
+{
+    if(a == b) return;
+    std::swap(mDense[a], mDense[b]);
+    std::swap(mOwners[a], mOwners[b]);
+    std::swap(mAddedTicks[a], mAddedTicks[b]);
+    mSparse[getEntityIndex(mOwners[a])] = static_cast<std::uint32_t>(a);
+    mSparse[getEntityIndex(mOwners[b])] = static_cast<std::uint32_t>(b);
+    stampChunk(a);
+    stampChunk(b);
+}
+
+void copyOne(EntityID id, BaseComponentPool& destination, EntityID newID) const override
+{
+    static_cast<ComponentPool<T>&>(destination).emplace(newID, get(id));
+}
+
+void mergeInto(BaseComponentPool& destination, const std::vector<EntityID>& newIDs) const override
+{
+    if(mDense.empty()) return;
+    auto& other{static_cast<ComponentPool<T>&>(destination)};
+
+    // the column goes over in one insert (a memcpy for trivially copyable types), then the owners
+    auto first{other.mDense.size()};
+    other.mDense.insert(other.mDense.end(), mDense.begin(), mDense.end());
+    other.mAddedTicks.insert(other.mAddedTicks.end(), mDense.size(), other.mChangeTick);
+    other.mOwners.reserve(first + mOwners.size());
+    for(auto owner : mOwners)
+    {
+        auto id{newIDs[getEntityIndex(owner)]};
+        auto index{getEntityIndex(id)};
+        if(index >= other.mSparse.size()) other.mSparse.resize(index + 1u, npos);
+        other.mSparse[index] = static_cast<std::uint32_t>(other.mOwners.size());
+        other.mOwners.emplace_back(id);
+    }
+
+    other.resizeChunks(other.mOwners.size());
+    for(auto chunk{first / chunkSize}; chunk < other.mChunkTicks.size(); ++chunk) other.mChunkTicks[chunk] = other.mChangeTick;
+}
+
+void clear() override
+{
+    mDense.clear();
+    mOwners.clear();
+    mSparse.clear();
+    mChunkTicks.clear();
+    mAddedTicks.clear();
+}
+
+// mutable access counts as a change
+T& get(EntityID id)
+{
+    assert(contains(id) && "ERROR: Component does not exist.");
+    auto pos{mSparse[getEntityIndex(id)]};
+    stampChunk(pos);
+    return mDense[pos];
+}
+
+const T& get(EntityID id) const
+{
+    assert(contains(id) && "ERROR: Component does not exist.");
+    return mDense[mSparse[getEntityIndex(id)]];
+}
+
+// == raw column access ==
+// (the mutable overloads mark the whole column as changed, or only the chunks of [first, first + count))
+std::size_t size() const noexcept override { return mDense.size(); }
+const EntityID* owners() const noexcept override { return mOwners.data(); }
+const void* rawData() const noexcept override { return mDense.data(); }
+EntityID* owners() noexcept { stampAll(); return mOwners.data(); }
+T* data() noexcept { stampAll(); return mDense.data(); }
+T* data(std::size_t first, std::size_t count) noexcept { stampRange(first, count); return mDense.data(); }
+const T* data() const noexcept { return mDense.data(); }
+
+void reserve(std::size_t count)
+{
+    mDense.reserve(count);
+    mOwners.reserve(count);
+}
+
+// resize both columns so they can be filled in place (e.g. by a bulk memcpy),
+// call rebuildIndex() once owners() has been written
+// (everything in the pool counts as added now)
+void resize(std::size_t count)
+{
+    mDense.resize(count);
+    mOwners.resize(count, nullEntity);
+    mAddedTicks.assign(count, mChangeTick);
+    resizeChunks(count);
+    stampAll();
+}
+
+// append 'count' copies of 'value', owned by ids[0, count), in one go
+// (one allocation per column, trivially copyable types are a plain memory fill)
+void fill(const EntityID* ids, std::size_t count, const T& value)
+{
+    if(count == 0u) return;
+
+    std::uint32_t maxIndex{0u};
+    for(std::size_t i{0u}; i < count; ++i)
+    {
+        assert(!contains(ids[i]) && "ERROR: entity already owns this component.");
+        maxIndex = std::max(maxIndex, getEntityIndex(ids[i]));
+    }
+    if(maxIndex >= mSparse.size()) mSparse.resize(maxIndex + 1u, npos);
+
+    auto first{mDense.size()};
+    mDense.insert(mDense.end(), count, value);
+    mOwners.insert(mOwners.end(), ids, ids + count);
+    mAddedTicks.insert(mAddedTicks.end(), count, mChangeTick);
+    for(std::size_t i{0u}; i < count; ++i) mSparse[getEntityIndex(ids[i])] = static_cast<std::uint32_t>(first + i);
+
+    resizeChunks(mOwners.size());
+    for(auto chunk{first / chunkSize}; chunk < mChunkTicks.size(); ++chunk) mChunkTicks[chunk] = mChangeTick;
+}
+
+void rebuildIndex()
+{
+    mSparse.clear();
+    for(std::uint32_t i{0u}; i < mOwners.size(); ++i)
+    {
+        auto index{getEntityIndex(mOwners[i])};
+        if(index >= mSparse.size()) mSparse.resize(index + 1u, npos);
+        mSparse[index] = i;
+    }
+}
+};
+
+
+// == ENTITY CLASS ==
+class Entity
+{
+private:
+friend class EntityManager;
+
+EntityManager* mManager;   // the world it lives in (changes when it is migrated)
+EntityID mID{nullEntity};
+
+bool mAlive{true};
+std::vector<std::unique_ptr<Component>> mComponentsContainer {};
+
+ComponentArray mComponentArray {}; // stores the component pointer
+ComponentBitset mComponentBitset {}; // stores the ID of a particular component
+ComponentBitset mDisabledBitset {};  // owned components that are switched off
+
+GroupBitset mGroupBitset {};
+
+// pooled components live in the manager, these are defined once it is complete
+template<typename T, typename... TArgs> T& addPooledComponent(TArgs&&... mArgs);
+template<typename T> T& getPooledComponent() const;
+template<typename T> const T& readPooledComponent() const;
+template<typename T> Shared<T> shareValue(const T& value);
+template<typename T> const T& resolveShared(Shared<T> handle) const;
+void notifyManager(ObserverEvent event, ComponentID type);
+void removePooledComponent(ComponentID type);
+void signatureChanged();
+void scheduleComponentSweep();
+
+public:
+// == CONSTRUCTOR/DESTRUCTOR ==
+Entity(EntityManager& manager, EntityID id) : mManager{&manager}, mID{id} {}
+~Entity() {}
+
+template<typename T> bool hasComponent() const
+{
+    // check if entity possesses a component of type 'T'
+    // (bitset returns the value (true/false) of given index, which happens to be the unique ID)
+    return mComponentBitset[getComponentTypeID<T>()];
+}
+
+// takes in T(specified component type) <T>
+// takes in any amount of specified arguments that will be forwarded to the Component constructor <TArgs>
+// (plain data types are forwarded to the manager's pool for T instead, the returned
+// reference is only valid until the next component of that type is added)
+template<typename T, typename... TArgs>
+T& addComponent(TArgs&&... mArgs)
+{
+    assert(!hasComponent<T>() && "ERROR: entity already owns this component.");
+
+    if constexpr(isTagComponent<T>)
+    {
+        static_assert(sizeof...(TArgs) == 0u && "ERROR: tags take no arguments.");
+        mComponentBitset[getComponentTypeID<T>()] = true;
+        signatureChanged();
+        notifyManager(ObserverEvent::Add, getComponentTypeID<T>());
+        return getTagInstance<T>();
+    }
+    else if constexpr(isPooledComponent<T>)
+    {
+        return addPooledComponent<T>(std::forward<TArgs>(mArgs)...);
+    }
+    else
+    {
+        // 1. allocate new component of type <T>,
+        T* component(new T(std::forward<TArgs>(mArgs)...));
+        // 2. components entity owner is set like so
+        component->setOwnership(this);
+        component->mTypeID = getComponentTypeID<T>();
+        // 3. wrap the regular pointer into a smart pointer
+        std::unique_ptr<Component> uC_Ptr{component};
+        // 4. store the component smart_ptr in our container
+        mComponentsContainer.emplace_back(std::move(uC_Ptr));
+
+        // add a component of type 'T' at mComponentArray's index -> (unique ID) &
+        // set the component's bitset (depending on its unique ID)
+        mComponentArray[getComponentTypeID<T>()] = component;
+        mComponentBitset[getComponentTypeID<T>()] = true;
+        signatureChanged();
+
+        component->initComponent();
+        notifyManager(ObserverEvent::Add, getComponentTypeID<T>());
+        // return reference (so it's not lost to the container's ownership) to the component
+        return *component;
+    }
+}
+
+// replace the value of a pooled component (on-set observers are notified)
+template<typename T, typename... TArgs>
+T& setComponent(TArgs&&... mArgs)
+{
+    static_assert(isPooledComponent<T> && "ERROR: heap components can not be reassigned, change them in place and call touchComponent().");
+    static_assert(!isTagComponent<T> && "ERROR: tags have no value to set.");
+    auto& component{getComponent<T>()};
+    if constexpr(std::is_constructible<T, TArgs...>::value) component = T(std::forward<TArgs>(mArgs)...);
+    else component = T{std::forward<TArgs>(mArgs)...};
+    notifyManager(ObserverEvent::Set, getComponentTypeID<T>());
+    return component;
+}
+
+// report a change made in place (through getComponent()) to the on-set observers
+template<typename T> void touchComponent()
+{
+    assert(hasComponent<T>() && "ERROR: Component does not exist.");
+    notifyManager(ObserverEvent::Set, getComponentTypeID<T>());
+}
+
+// == SHARED COMPONENTS ==
+// attach the manager's single copy of 'value' (a Shared<T> handle component)
+template<typename T> Shared<T> addShared(const T& value)
+{
+    auto handle{shareValue(value)};
+    addComponent<Shared<T>>(handle);
+    return handle;
+}
+
+// point the entity at the shared copy of another value (adds the handle if it has none)
+template<typename T> Shared<T> setShared(const T& value)
+{
+    auto handle{shareValue(value)};
+    if(hasComponent<Shared<T>>()) setComponent<Shared<T>>(handle);
+    else addComponent<Shared<T>>(handle);
+    return handle;
+}
+
+template<typename T> const T& getShared() const
+{
+    return resolveShared(readComponent<Shared<T>>());
+}
+
+// remove the component of type 'T' (false if the entity does not own one)
+// pooled components leave their column right away (the last one is moved into the gap),
+// heap components are detached right away (no more updates, lookups or snapshots) and
+// destroyed at the manager's next refresh, so a component may remove itself or a sibling mid-update
+// (pointers other components cached to it dangle from then on)
+template<typename T> bool removeComponent()
+{
+    if(!hasComponent<T>()) return false;
+
+    // (the signature change goes first, so owning groups let go of the component before it leaves its pool)
+    auto type{getComponentTypeID<T>()};
+    mComponentBitset[type] = false;
+    mDisabledBitset[type] = false;
+    signatureChanged();
+    if constexpr(isPooledComponent<T>)
+    {
+        if constexpr(!isTagComponent<T>) removePooledComponent(type);
+    }
+    else
+    {
+        mComponentArray[type] = nullptr;
+        scheduleComponentSweep();
+    }
+    notifyManager(ObserverEvent::Remove, type);
+    return true;
+}
+
+// false for heap components that have been removed but not swept yet
+bool ownsComponent(const Component& component) const noexcept
+{
+    return mComponentBitset[component.mTypeID] && mComponentArray[component.mTypeID] == &component;
+}
+
+// owned and enabled, i.e. receives update/render calls
+bool runsComponent(const Component& component) const noexcept
+{
+    return ownsComponent(component) && !mDisabledBitset[component.mTypeID];
+}
+
+// == ENABLE/DISABLE ==
+// a disabled component keeps its data and its place in storage, but queries skip the entity
+// (and heap components get no update/render calls) until it is enabled again
+// toggling is a bit flip, not a structural change
+template<typename T> void setComponentEnabled(bool enabled)
+{
+    setComponentEnabled(getComponentTypeID<T>(), enabled);
+}
+
+// by type id, for code that only knows the type at runtime (snapshot/rollback restore)
+void setComponentEnabled(ComponentID type, bool enabled)
+{
+    assert(mComponentBitset[type] && "ERROR: Component does not exist.");
+    mDisabledBitset[type] = !enabled;
+}
+
+template<typename T> bool isComponentEnabled() const
+{
+    return hasComponent<T>() && !mDisabledBitset[getComponentTypeID<T>()];
+}
+
+// owned and enabled components
+ComponentBitset getEnabledSignature() const noexcept { return mComponentBitset & ~mDisabledBitset; }
+
+// == RESTORING SAVED STATE ==
+// snapshots/rollback keep tags as a bitmask, this sets the bits of the tag types in 'types' to
+// those in 'tags' at once (no observers are notified, like for the bulk column writes)
+void restoreTags(const ComponentBitset& types, const ComponentBitset& tags)
+{
+    auto signature{(mComponentBitset & ~types) | (tags & types)};
+    if(signature == mComponentBitset) return;
+    mComponentBitset = signature;
+    mDisabledBitset &= signature;
+    signatureChanged();
+}
+
+// == GROUP MANAGEMENT ==
+bool hasGroup(GroupID group) const noexcept
+{
+    return mGroupBitset[group];
+}
+
+void addGroup(GroupID group) noexcept;
+
+void deleteGroup (GroupID group) noexcept;
+
+
+// == accessor functions ==
+bool isAlive() const { return mAlive; }
+void destroyObj() { mAlive = false; }
+
+EntityID getID() const noexcept { return mID; }
+EntityManager& getManager() const noexcept { return *mManager; }
+const ComponentBitset& getSignature() const noexcept { return mComponentBitset; }
+const GroupBitset& getGroups() const noexcept { return mGroupBitset; }
+
+// heap components in the order they were added (check ownsComponent() for removed ones)
+const std::vector<std::unique_ptr<Component>>& getHeapComponents() const noexcept
+{
+    return mComponentsContainer;
+}
+
+template<typename T> T& getComponent() const
+{
+    if constexpr(isTagComponent<T>)
+    {
+        assert(hasComponent<T>() && "ERROR: Component does not exist.");
+        return getTagInstance<T>();
+    }
+    else if constexpr(isPooledComponent<T>)
+    {
+        return getPooledComponent<T>();
+    }
+    else
+    {
+        // retrieve pointer to given component of type 'T' from mComponentArray
+        assert(hasComponent<T>() && "ERROR: Component does not exist.");
+        auto ptr{mComponentArray[getComponentTypeID<T>()]};
+        return *static_cast<T*>(ptr);
+    }
+}
+
+// read-only access, unlike getComponent() this does not count as a change for pooled components
+template<typename T> const T& readComponent() const
+{
+    if constexpr(isTagComponent<T>)
+    {
+        return getComponent<T>();
+    }
+    else if constexpr(isPooledComponent<T>)
+    {
+        return readPooledComponent<T>();
+    }
+    else
+    {
+        return getComponent<T>();
+    }
+}
+
+// destroy heap components removed since the last sweep (called by the manager)
+void sweepComponents()
+{
+    mComponentsContainer.erase
+    (std::remove_if(mComponentsContainer.begin(), mComponentsContainer.end(),
+    [this](const std::unique_ptr<Component>& component)
+    {
+        return !ownsComponent(*component);
+    }),
+    mComponentsContainer.end());
+}
+
+// == main loop functions ==
+// (indexed, since a component may remove itself or a sibling meanwhile)
+void updateObj(const float& dt)
+{
+    for (std::size_t i{0u}; i < mComponentsContainer.size(); ++i)
+    {
+        auto& component{*mComponentsContainer[i]};
+        if(runsComponent(component)) component.updateComponent(dt);
+    }
+}
+
+void renderObj(sf::RenderWindow& targetWin)
+{
+    for (auto& component : mComponentsContainer)
+    {
+        if(runsComponent(*component)) component->renderComponent(targetWin);
+    }
+}
+
+};
+
+// == PREFABS ==
+// a template for stamping out many alike entities with EntityManager::instantiate()
+// the signature and groups are worked out once, pooled components are copied from one
+// default value column by column, heap components are constructed per entity from the
+// stored constructor arguments (so e.g. randomised constructors still differ per entity)
+class Prefab
+{
+private:
+friend class EntityManager;
+
+struct PooledDefault
+{
+    std::shared_ptr<const void> mValue;
+    void (*spawn)(EntityManager& manager, const void* value, const EntityID* ids, std::size_t count);
+};
+
+ComponentBitset mSignature {};
+ComponentBitset mPooledSignature {};
+GroupBitset mGroups {};
+std::vector<PooledDefault> mPooled {};
+std::vector<std::function<void(Entity&)>> mHeap {};    // in the order they were declared
+
+public:
+// add a component of type 'T' (arguments are copied and used for every instance)
+template<typename T, typename... TArgs> Prefab& with(TArgs&&... mArgs);
+
+Prefab& inGroup(GroupID group) noexcept
+{
+    mGroups[group] = true;
+    return *this;
+}
+
+template<typename T> bool hasComponent() const { return mSignature[getComponentTypeID<T>()]; }
+const ComponentBitset& getSignature() const noexcept { return mSignature; }
+const GroupBitset& getGroups() const noexcept { return mGroups; }
+};
+
+// == CACHED QUERY STORAGE ==
+// the entities matching a signature, kept up to date by the manager as signatures change
+// (an entity is re-tested only when its own signature changes, nothing is rescanned per run)
+class BaseCachedQuery : sf::NonCopyable
+{
+protected:
+friend class EntityManager;
+static constexpr std::uint32_t npos{~std::uint32_t{0}};
+
+EntityManager* mManager;
+ComponentBitset mSignature {};
+std::vector<Entity*> mMatches {};
+std::vector<std::uint32_t> mPositions {};  // entity index -> position in mMatches (npos if absent)
+
+BaseCachedQuery(EntityManager& manager, const ComponentBitset& signature) : mManager{&manager}, mSignature{signature} {}
+
+bool holds(const Entity& entity) const noexcept
+{
+    auto index{getEntityIndex(entity.getID())};
+    return index < mPositions.size() && mPositions[index] != npos && mMatches[mPositions[index]] == &entity;
+}
+
+void drop(const Entity& entity)
+{
+    if(!holds(entity)) return;
+
+    // swap the last match into the hole
+    auto index{getEntityIndex(entity.getID())};
+    auto pos{mPositions[index]};
+    mMatches[pos] = mMatches.back();
+    mPositions[getEntityIndex(mMatches[pos]->getID())] = pos;
+    mMatches.pop_back();
+    mPositions[index] = npos;
+}
+
+void update(Entity& entity)
+{
+    bool matches{(entity.getSignature() & mSignature) == mSignature};
+    if(!matches)
+    {
+        drop(entity);
+        return;
+    }
+    if(holds(entity)) return;
+
+    auto index{getEntityIndex(entity.getID())};
+    if(index >= mPositions.size()) mPositions.resize(index + 1u, npos);
+    mPositions[index] = static_cast<std::uint32_t>(mMatches.size());
+    mMatches.emplace_back(&entity);
+}
+
+void reset()
+{
+    mMatches.clear();
+    mPositions.clear();
+}
+
+public:
+virtual ~BaseCachedQuery() {}
+
+std::size_t size() const noexcept { return mMatches.size(); }
+};
+
+// == ENTITY MANAGER CLASS ==
+class EntityManager
+{
+private:
+std::vector<std::unique_ptr<Entity>> mEntityContainer {};
+std::array<std::vector<Entity*>, maxGroups> mGroupedEntities {};
+
+// one pool per pooled component type (indexed by ComponentID, null for heap components)
+std::array<std::unique_ptr<BaseComponentPool>, maxComponents> mComponentPools {};
+
+// entity index -> live entity, plus the current version of every slot
+std::vector<Entity*> mEntityLookup {};
+std::vector<std::uint32_t> mEntityVersions {};
+std::vector<std::uint32_t> mFreeIndices {};
+
+// change tracking: pools stamp mutated chunks with the current tick,
+// mStructureTick is the tick of the last entity creation/destruction/group change
+std::uint32_t mChangeTick{1u};
+std::uint32_t mStructureTick{1u};
+
+std::vector<EntityID> mSpawnScratch {};
+GroupBitset mStaleGroups {};     // groups holding entities that have left them since the last refresh
+std::vector<BaseCachedQuery*> mCachedQueries {};
+
+// owning groups: the entities owning all of mTypes sit at [0, mSize) of each of those pools, in the same order
+struct OwningGroupState
+{
+    ComponentBitset mOwned {};
+    std::vector<ComponentID> mTypes {};
+    std::size_t mSize{0u};
+};
+std::vector<OwningGroupState> mOwningGroups {};
+ComponentBitset mOwnedTypes {};
+std::vector<EntityID> mComponentSweep {};   // entities with removed heap components to destroy
+
+// one store per relation kind, both directions indexed by entity index
+struct RelationStore
+{
+    std::vector<EntityID> mTargets {};                  // source -> its target (nullEntity = none)
+    std::vector<std::uint32_t> mPositions {};           // source -> where it sits in its target's mSources
+    std::vector<std::vector<EntityID>> mSources {};     // target -> everything related to it
+};
+std::array<RelationStore, relationCount> mRelations {};
+
+// one slot per resource type (indexed by ResourceID)
+struct BaseResource
+{
+    virtual ~BaseResource() {}
+};
+
+template<typename T> struct ResourceHolder : BaseResource
+{
+    T mValue;
+
+    template<typename... TArgs> static T make(TArgs&&... mArgs)
+    {
+        if constexpr(std::is_constructible<T, TArgs...>::value) return T(std::forward<TArgs>(mArgs)...);
+        else return T{std::forward<TArgs>(mArgs)...};
+    }
+
+    template<typename... TArgs> ResourceHolder(TArgs&&... mArgs) : mValue(make(std::forward<TArgs>(mArgs)...)) {}
+};
+
+std::array<std::unique_ptr<BaseResource>, maxResources> mResources {};
+
+// one store of distinct values per shared type (indexed by the ComponentID of Shared<T>)
+struct BaseSharedStore
+{
+    virtual ~BaseSharedStore() {}
+    // handles are indices into one manager's store: re-point the handles of entities
+    // that just moved to 'destination' (their new ids) at its copies of the values
+    virtual void remapInto(EntityManager& destination, const EntityID* ids, std::size_t count) const = 0;
+};
+
+template<typename T> struct SharedStore : BaseSharedStore
+{
+    std::vector<T> mValues {};
+    std::unordered_multimap<std::size_t, std::uint32_t> mByHash {};
+
+    void remapInto(EntityManager& destination, const EntityID* ids, std::size_t count) const override
+    {
+        auto& pool{destination.getPool<Shared<T>>()};
+        std::vector<std::uint32_t> remapped(mValues.size(), ~std::uint32_t{0});
+        for(std::size_t i{0u}; i < count; ++i)
+        {
+            if(!pool.contains(ids[i])) continue;
+            auto& handle{pool.get(ids[i])};
+            auto& remappedHandle{remapped[handle.getIndex()]};
+            if(remappedHandle == ~std::uint32_t{0}) remappedHandle = destination.share(mValues[handle.getIndex()]).mHandle;
+            handle.mHandle = remappedHandle;
+        }
+    }
+};
+
+std::array<std::unique_ptr<BaseSharedStore>, maxComponents> mSharedStores {};
+std::uint32_t mSharedGeneration{0u};    // of every handle share() hands out, moves on with clear()
+
+template<typename T> SharedStore<T>& getSharedStore()
+{
+    auto& store{mSharedStores[getComponentTypeID<Shared<T>>()]};
+    if(!store) store.reset(new SharedStore<T>{});
+    return *static_cast<SharedStore<T>*>(store.get());
+}
+const SystemAccess* mActiveAccess{nullptr};
+
+// observers: callbacks per component type and event, events are queued in order
+// and handed out in runs at the next flushObservers()
+public:
+using ObserverCallback = std::function<void(EntityManager& manager, const EntityID* ids, std::size_t count)>;
+
+private:
+struct ObserverRecord
+{
+    EntityID mID;
+    ObserverEvent mEvent;
+};
+
+std::array<std::array<std::vector<ObserverCallback>, observerEventCount>, maxComponents> mObservers {};
+std::array<ComponentBitset, observerEventCount> mObserved {};   // (event) types with at least one observer
+std::array<std::vector<ObserverRecord>, maxComponents> mObserverQueues {};
+std::vector<ObserverRecord> mObserverScratch {};
+std::vector<EntityID> mObserverRun {};
+
+// event channels: one per event type, events are appended to mPending during the frame and
+// handed to every handler as one span at the next flushEvents(), both buffers keep their capacity
+struct BaseEventChannel
+{
+    virtual ~BaseEventChannel() {}
+    virtual void dispatch(EntityManager& manager) = 0;
+    virtual void discard() noexcept = 0;
+};
+
+template<typename T> struct EventChannel : BaseEventChannel
+{
+    // (a deque: handlers may subscribe others while they run, that must not move the running one)
+    std::deque<std::function<void(EntityManager&, EventSpan<T>)>> mHandlers {};
+    std::vector<T> mPending {};
+    std::vector<T> mDispatching {};
+
+    void dispatch(EntityManager& manager) override
+    {
+        if(mPending.empty()) return;
+
+        // (swapped out first, events emitted by the handlers go to the next flush)
+        mDispatching.clear();
+        std::swap(mDispatching, mPending);
+        EventSpan<T> events{mDispatching.data(), mDispatching.data() + mDispatching.size()};
+        // handlers subscribed by a handler get their first events at the next flush
+        auto count{mHandlers.size()};
+        for(std::size_t i{0u}; i < count; ++i) mHandlers[i](manager, events);
+        mDispatching.clear();
+    }
+
+    void discard() noexcept override { mPending.clear(); }
+};
+
+std::array<std::unique_ptr<BaseEventChannel>, maxEventTypes> mEventChannels {};
+
+template<typename T> EventChannel<T>& getEventChannel()
+{
+    auto& channel{mEventChannels[getEventTypeID<T>()]};
+    if(!channel) channel.reset(new EventChannel<T>{});
+    return *static_cast<EventChannel<T>*>(channel.get());
+}
+
+EntityID acquireID()
+{
+    // reuse a freed slot if there is one
+    // (slots claimed directly through addEntityWithID may still sit in the free list, skip those)
+    while(!mFreeIndices.empty())
+    {
+        auto index{mFreeIndices.back()};
+        mFreeIndices.pop_back();
+        if(mEntityLookup[index] == nullptr) return makeEntityID(index, mEntityVersions[index]);
+    }
+
+    auto index{static_cast<std::uint32_t>(mEntityLookup.size())};
+    assert(index < entityIndexMask && "ERROR: ran out of entity slots.");
+    mEntityLookup.emplace_back(nullptr);
+    mEntityVersions.emplace_back(0u);
+    return makeEntityID(index, 0u);
+}
+
+void releaseEntity(Entity& entity)
+{
+    // drop pooled components, then retire the id so stale copies stop resolving
+    for(auto& group : mOwningGroups) leaveOwningGroup(group, entity.mID);
+    for(ComponentID id{0u}; id < maxComponents; ++id)
+    {
+        if(!entity.mComponentBitset[id]) continue;
+        if(mComponentPools[id]) mComponentPools[id]->remove(entity.mID);
+        notify(ObserverEvent::Remove, id, entity.mID);
+    }
+
+    releaseRelations(entity.mID);
+    for(auto* query : mCachedQueries) query->drop(entity);
+
+    auto index{getEntityIndex(entity.mID)};
+    mStructureTick = mChangeTick;
+    mEntityLookup[index] = nullptr;
+    mEntityVersions[index] = (mEntityVersions[index] + 1u) & entityVersionMask;
+    mFreeIndices.emplace_back(index);
+}
+
+// drop the source's pair from one store
+static void unrelateIn(RelationStore& store, EntityID source)
+{
+    auto sourceIndex{getEntityIndex(source)};
+    if(sourceIndex >= store.mTargets.size() || store.mTargets[sourceIndex] == nullEntity) return;
+
+    // swap the last source into the hole so the target's list stays packed
+    auto& sources{store.mSources[getEntityIndex(store.mTargets[sourceIndex])]};
+    auto pos{store.mPositions[sourceIndex]};
+    sources[pos] = sources.back();
+    store.mPositions[getEntityIndex(sources[pos])] = pos;
+    sources.pop_back();
+    store.mTargets[sourceIndex] = nullEntity;
+}
+
+// drop every pair the entity is part of, on either side (of the manager's stores or a saved copy)
+static void releaseRelations(std::array<RelationStore, relationCount>& stores, EntityID id)
+{
+    auto index{getEntityIndex(id)};
+    for(auto& store : stores)
+    {
+        unrelateIn(store, id);
+        if(index < store.mSources.size())
+        {
+            for(auto source : store.mSources[index]) store.mTargets[getEntityIndex(source)] = nullEntity;
+            store.mSources[index].clear();
+        }
+    }
+}
+
+void releaseRelations(EntityID id) { releaseRelations(mRelations, id); }
+
+// make sure there is a pool for the type of 'like'
+BaseComponentPool& ensurePool(ComponentID id, const BaseComponentPool& like)
+{
+    auto& pool{mComponentPools[id]};
+    if(!pool)
+    {
+        pool.reset(like.createEmpty());
+        pool->setChangeTick(mChangeTick);
+    }
+    return *pool;
+}
+
+// take in an entity that was living in another manager, under an id from acquireID()
+// (its pooled components have to be moved separately, call signatureChanged() once they are)
+void adoptEntity(std::unique_ptr<Entity> entity, EntityID id)
+{
+    entity->mManager = this;
+    entity->mID = id;
+    mEntityLookup[getEntityIndex(id)] = entity.get();
+    for(GroupID group{0u}; group < maxGroups; ++group)
+    {
+        if(entity->mGroupBitset[group]) mGroupedEntities[group].emplace_back(entity.get());
+    }
+    mEntityContainer.emplace_back(std::move(entity));
+    mStructureTick = mChangeTick;
+}
+
+// forget an entity that moved to another manager (its slot is retired like a destroyed one's)
+void abandonSlot(EntityID id)
+{
+    auto index{getEntityIndex(id)};
+    mEntityLookup[index] = nullptr;
+    mEntityVersions[index] = (mEntityVersions[index] + 1u) & entityVersionMask;
+    mFreeIndices.emplace_back(index);
+    mStructureTick = mChangeTick;
+}
+
+void notifyAll(ObserverEvent event, const Entity& entity)
+{
+    for(ComponentID id{0u}; id < maxComponents; ++id)
+    {
+        if(entity.mComponentBitset[id]) notify(event, id, entity.mID);
+    }
+}
+
+bool isInOwningGroup(const OwningGroupState& group, EntityID id) const noexcept
+{
+    auto pos{mComponentPools[group.mTypes[0]]->indexOf(id)};
+    return pos != BaseComponentPool::noIndex && pos < group.mSize;
+}
+
+void enterOwningGroup(OwningGroupState& group, EntityID id)
+{
+    if(isInOwningGroup(group, id)) return;
+    for(auto type : group.mTypes)
+    {
+        auto& pool{*mComponentPools[type]};
+        pool.swapElements(pool.indexOf(id), group.mSize);
+    }
+    ++group.mSize;
+}
+
+void leaveOwningGroup(OwningGroupState& group, EntityID id)
+{
+    if(!isInOwningGroup(group, id)) return;
+    --group.mSize;
+    for(auto type : group.mTypes)
+    {
+        auto& pool{*mComponentPools[type]};
+        pool.swapElements(pool.indexOf(id), group.mSize);
+    }
+}
+
+public:
+EntityManager() {}
+~EntityManager()
+{
+    for(auto* query : mCachedQueries) query->mManager = nullptr;
+}
+
+// == CACHED QUERIES ==
+// (see CachedQuery, they register themselves)
+void registerCachedQuery(BaseCachedQuery& query)
+{
+    mCachedQueries.emplace_back(&query);
+    for(auto& entity : mEntityContainer) query.update(*entity);
+}
+
+void unregisterCachedQuery(BaseCachedQuery& query)
+{
+    mCachedQueries.erase(std::remove(mCachedQueries.begin(), mCachedQueries.end(), &query), mCachedQueries.end());
+}
+
+// re-test the entity against every cached query (called whenever its signature changes)
+void signatureChanged(Entity& entity)
+{
+    for(auto* query : mCachedQueries) query->update(entity);
+    for(auto& group : mOwningGroups)
+    {
+        bool matches{(entity.mComponentBitset & group.mOwned) == group.mOwned};
+        if(matches) enterOwningGroup(group, entity.mID);
+        else leaveOwningGroup(group, entity.mID);
+    }
+}
+
+// == OWNING GROUPS ==
+// the pools of a group's types are partitioned, members first, so iterating it walks
+// aligned arrays (see OwningGroup); a component type can be owned by one group only
+template<typename... Ts> OwningGroup<Ts...> group();
+
+const OwningGroupState& getOwningGroup(std::size_t index) const noexcept { return mOwningGroups[index]; }
+
+Entity& addEntity()
+{
+    // 1. create new entity (add on the heap and assign pointer to it)
+    auto id{acquireID()};
+    Entity* entity{new Entity{*this, id}};
+    // 2. wrap pure pointer into smart pointer
+    std::unique_ptr<Entity> uPtr{entity};
+    // 3. place smart pointer -> entity obj in container
+    mEntityContainer.emplace_back(std::move(uPtr));
+
+    mEntityLookup[getEntityIndex(id)] = entity;
+    mStructureTick = mChangeTick;
+    signatureChanged(*entity);
+    return *entity;
+}
+
+// create 'count' entities from a prefab at once: containers, groups and pools grow once
+// and pooled components are filled per column instead of per entity
+// (the ids of the new entities are appended to 'ids' if given)
+void instantiate(const Prefab& prefab, std::size_t count, std::vector<EntityID>* ids = nullptr)
+{
+    if(count == 0u) return;
+
+    auto& spawned{mSpawnScratch};
+    spawned.clear();
+    spawned.reserve(count);
+    mEntityContainer.reserve(mEntityContainer.size() + count);
+    mEntityLookup.reserve(mEntityLookup.size() + count);
+    mEntityVersions.reserve(mEntityVersions.size() + count);
+
+    auto first{mEntityContainer.size()};
+    for(std::size_t i{0u}; i < count; ++i)
+    {
+        auto id{acquireID()};
+        Entity* entity{new Entity{*this, id}};
+        mEntityContainer.emplace_back(std::unique_ptr<Entity>{entity});
+        mEntityLookup[getEntityIndex(id)] = entity;
+
+        entity->mComponentBitset = prefab.mPooledSignature;
+        entity->mGroupBitset = prefab.mGroups;
+        spawned.emplace_back(id);
+    }
+
+    for(auto& pooled : prefab.mPooled) pooled.spawn(*this, pooled.mValue.get(), spawned.data(), count);
+    for(ComponentID id{0u}; id < maxComponents; ++id)
+    {
+        if(!prefab.mPooledSignature[id] || !mObserved[static_cast<std::size_t>(ObserverEvent::Add)][id]) continue;
+        for(auto spawnedID : spawned) mObserverQueues[id].push_back({spawnedID, ObserverEvent::Add});
+    }
+
+    if(!prefab.mHeap.empty())
+    {
+        for(auto i{first}; i < mEntityContainer.size(); ++i)
+        {
+            for(auto& construct : prefab.mHeap) construct(*mEntityContainer[i]);
+        }
+    }
+
+    for(GroupID group{0u}; group < maxGroups; ++group)
+    {
+        if(!prefab.mGroups[group]) continue;
+        auto& grouped{mGroupedEntities[group]};
+        grouped.reserve(grouped.size() + count);
+        for(auto i{first}; i < mEntityContainer.size(); ++i) grouped.emplace_back(mEntityContainer[i].get());
+    }
+
+    if(!mCachedQueries.empty() || !mOwningGroups.empty())
+    {
+        for(auto i{first}; i < mEntityContainer.size(); ++i) signatureChanged(*mEntityContainer[i]);
+    }
+
+    mStructureTick = mChangeTick;
+    if(ids != nullptr) ids->insert(ids->end(), spawned.begin(), spawned.end());
+}
+
+// create an entity with a given id (used when restoring saved/received state)
+// the slot must not be occupied
+Entity& addEntityWithID(EntityID id)
+{
+    auto index{getEntityIndex(id)};
+    while(mEntityLookup.size() <= index)
+    {
+        // slots skipped over become free for regular addEntity() calls
+        mFreeIndices.emplace_back(static_cast<std::uint32_t>(mEntityLookup.size()));
+        mEntityLookup.emplace_back(nullptr);
+        mEntityVersions.emplace_back(0u);
+    }
+    assert(mEntityLookup[index] == nullptr && "ERROR: entity slot already in use.");
+
+    mEntityVersions[index] = getEntityVersion(id);
+    Entity* entity{new Entity{*this, id}};
+    mEntityContainer.emplace_back(std::unique_ptr<Entity>{entity});
+    mEntityLookup[index] = entity;
+    mStructureTick = mChangeTick;
+    signatureChanged(*entity);
+    return *entity;
+}
+
+// resolve an id to its entity (nullptr if it has been destroyed and swept)
+Entity* getEntity(EntityID id) const noexcept
+{
+    auto index{getEntityIndex(id)};
+    if(index >= mEntityLookup.size() || mEntityVersions[index] != getEntityVersion(id)) return nullptr;
+    return mEntityLookup[index];
+}
+
+const std::vector<std::unique_ptr<Entity>>& getEntities() const noexcept
+{
+    return mEntityContainer;
+}
+
+std::size_t getEntityCount() const noexcept
+{
+    return mEntityContainer.size();
+}
+
+// == POOL ACCESS ==
+template<typename T> ComponentPool<T>& getPool()
+{
+    static_assert(isPooledComponent<T> && "ERROR: heap components (derived from Component) have no pool.");
+    static_assert(!isTagComponent<T> && "ERROR: tags have no pool, only a signature bit.");
+    auto& pool{mComponentPools[getComponentTypeID<T>()]};
+    if(!pool)
+    {
+        pool.reset(new ComponentPool<T>{});
+        pool->setChangeTick(mChangeTick);
+    }
+    return *static_cast<ComponentPool<T>*>(pool.get());
+}
+
+BaseComponentPool* getPool(ComponentID id) const noexcept
+{
+    return mComponentPools[id].get();
+}
+
+// set the signature bit of every entity that owns a component in the given pool
+// (call after a pool was filled in bulk through ComponentPool::resize/data/owners)
+// returns false if the pool references an entity that does not exist
+bool markPoolOwners(ComponentID id)
+{
+    auto* pool{mComponentPools[id].get()};
+    if(pool == nullptr) return true;
+
+    auto* owners{pool->owners()};
+    for(std::size_t i{0u}; i < pool->size(); ++i)
+    {
+        auto* entity{getEntity(owners[i])};
+        if(entity == nullptr) return false;
+        entity->mComponentBitset[id] = true;
+        signatureChanged(*entity);
+    }
+    return true;
+}
+
+// clear the signature bit of every entity that owns a component in the given pool
+// (call before a pool is overwritten in bulk, markPoolOwners() afterwards)
+void clearPoolOwners(ComponentID id)
+{
+    auto* pool{mComponentPools[id].get()};
+    if(pool == nullptr) return;
+
+    // (back to front, owning groups swap leaving members towards the end of their range)
+    const auto* owners{static_cast<const BaseComponentPool*>(pool)->owners()};
+    for(auto i{pool->size()}; i-- > 0u;)
+    {
+        if(auto* entity{getEntity(owners[i])})
+        {
+            entity->mComponentBitset[id] = false;
+            signatureChanged(*entity);
+        }
+    }
+}
+
+// == ID ALLOCATOR STATE ==
+// slot versions and free list, enough to make future addEntity() calls hand out the same ids again
+// entities that are destroyed but not swept yet are saved as freed, the way the next refresh() frees them
+// (restoring is only valid once the live entities match the ones of the saved state)
+struct AllocatorState
+{
+    std::vector<std::uint32_t> mVersions {};
+    std::vector<std::uint32_t> mFreeIndices {};
+};
+
+void saveAllocator(AllocatorState& state) const
+{
+    state.mVersions.assign(mEntityVersions.begin(), mEntityVersions.end());
+    state.mFreeIndices.assign(mFreeIndices.begin(), mFreeIndices.end());
+    for(auto& entity : mEntityContainer)
+    {
+        if(entity->isAlive()) continue;
+        auto index{getEntityIndex(entity->mID)};
+        state.mVersions[index] = (state.mVersions[index] + 1u) & entityVersionMask;
+        state.mFreeIndices.emplace_back(index);
+    }
+}
+
+void restoreAllocator(const AllocatorState& state)
+{
+    auto count{state.mVersions.size()};
+    assert(count <= mEntityLookup.size() && "ERROR: allocator state is newer than the manager.");
+
+    // slots created after the save act as if they never existed: version 0,
+    // handed out in index order once the saved free list is used up
+    mFreeIndices.clear();
+    for(auto index{mEntityLookup.size()}; index > count; --index)
+    {
+        assert(mEntityLookup[index - 1u] == nullptr && "ERROR: live entity in a slot the allocator state does not know.");
+        mEntityVersions[index - 1u] = 0u;
+        mFreeIndices.emplace_back(static_cast<std::uint32_t>(index - 1u));
+    }
+    mFreeIndices.insert(mFreeIndices.end(), state.mFreeIndices.begin(), state.mFreeIndices.end());
+    std::copy(state.mVersions.begin(), state.mVersions.end(), mEntityVersions.begin());
+}
+
+// == RELATION STATE ==
+// every pair of every relation kind, as plain copies of the stores (they keep their capacity)
+// pairs of entities that are destroyed but not swept yet are left out, as the next refresh() drops them
+// (restoring is only valid once the live entities match the ones of the saved state)
+struct RelationState
+{
+    std::array<RelationStore, relationCount> mStores {};
+};
+
+void saveRelations(RelationState& state) const
+{
+    state.mStores = mRelations;
+    for(auto& entity : mEntityContainer)
+    {
+        if(!entity->isAlive()) releaseRelations(state.mStores, entity->mID);
+    }
+}
+void restoreRelations(const RelationState& state) { mRelations = state.mStores; }
+
+// destroy every entity and component right away (no sweep needed)
+// (on-remove observers hear about every component at the next flush)
+void clear()
+{
+    for(auto& entity : mEntityContainer)
+    {
+        for(ComponentID id{0u}; id < maxComponents; ++id)
+        {
+            if(entity->mComponentBitset[id]) notify(ObserverEvent::Remove, id, entity->mID);
+        }
+    }
+    for(auto& group : mGroupedEntities) group.clear();
+    mStaleGroups.reset();
+    mComponentSweep.clear();
+    for(auto* query : mCachedQueries) query->reset();
+    for(auto& group : mOwningGroups) group.mSize = 0u;
+    for(auto& store : mRelations) store = RelationStore{};
+    for(auto& pool : mComponentPools)
+    {
+        if(pool) pool->clear();
+    }
+    mEntityContainer.clear();
+    mEntityLookup.clear();
+    mEntityVersions.clear();
+    mFreeIndices.clear();
+    // no entity holds a handle anymore, so the shared values go too (loading snapshots over and over
+    // does not pile them up), handles kept elsewhere (e.g. in prefabs) are stale and have to be shared again
+    for(auto& store : mSharedStores) store.reset();
+    mSharedGeneration = (mSharedGeneration + 1u) & sharedGenerationMask;
+    mStructureTick = mChangeTick;
+}
+
+// == RELATIONS ==
+// make 'target' the source's target of this kind (replacing the previous one)
+// pairs are dropped automatically once either side is destroyed and swept
+// they are not part of snapshots (rollback keeps them, see saveRelations)
+// false if either entity does not exist
+bool relate(EntityID source, Relation kind, EntityID target)
+{
+    if(getEntity(source) == nullptr || getEntity(target) == nullptr || source == target) return false;
+
+    unrelate(source, kind);
+    auto& store{mRelations[static_cast<std::size_t>(kind)]};
+    auto sourceIndex{getEntityIndex(source)};
+    auto targetIndex{getEntityIndex(target)};
+    if(sourceIndex >= store.mTargets.size())
+    {
+        store.mTargets.resize(sourceIndex + 1u, nullEntity);
+        store.mPositions.resize(sourceIndex + 1u, 0u);
+    }
+    if(targetIndex >= store.mSources.size()) store.mSources.resize(targetIndex + 1u);
+
+    auto& sources{store.mSources[targetIndex]};
+    store.mTargets[sourceIndex] = target;
+    store.mPositions[sourceIndex] = static_cast<std::uint32_t>(sources.size());
+    sources.emplace_back(source);
+    return true;
+}
+
+void unrelate(EntityID source, Relation kind)
+{
+    unrelateIn(mRelations[static_cast<std::size_t>(kind)], source);
+}
+
+// the entity the source relates to (nullEntity if none)
+EntityID getRelationTarget(EntityID source, Relation kind) const noexcept
+{
+    auto& store{mRelations[static_cast<std::size_t>(kind)]};
+    auto sourceIndex{getEntityIndex(source)};
+    if(getEntity(source) == nullptr || sourceIndex >= store.mTargets.size()) return nullEntity;
+    return store.mTargets[sourceIndex];
+}
+
+// everything that relates to the target, e.g. getRelated(Relation::ChildOf, parent) are its children
+EntityRange getRelated(Relation kind, EntityID target) const noexcept
+{
+    auto& store{mRelations[static_cast<std::size_t>(kind)]};
+    auto targetIndex{getEntityIndex(target)};
+    if(getEntity(target) == nullptr || targetIndex >= store.mSources.size()) return EntityRange{};
+    auto& sources{store.mSources[targetIndex]};
+    return EntityRange{sources.data(), sources.data() + sources.size()};
+}
+
+// == SHARED COMPONENTS ==
+// handle to the stored copy of 'value', stored on first use: equal values get the same handle
+template<typename T> Shared<T> share(const T& value)
+{
+    auto& store{getSharedStore<T>()};
+    auto hash{SharedTraits<T>::hash(value)};
+    auto range{store.mByHash.equal_range(hash)};
+    for(auto it{range.first}; it != range.second; ++it)
+    {
+        if(SharedTraits<T>::equal(store.mValues[it->second], value)) return Shared<T>{(mSharedGeneration << sharedIndexBits) | it->second};
+    }
+
+    auto index{static_cast<std::uint32_t>(store.mValues.size())};
+    assert(index <= sharedIndexMask && "ERROR: too many distinct shared values of one type.");
+    store.mValues.emplace_back(value);
+    store.mByHash.emplace(hash, index);
+    return Shared<T>{(mSharedGeneration << sharedIndexBits) | index};
+}
+
+template<typename T> const T& getShared(Shared<T> handle) const
+{
+    auto* store{static_cast<const SharedStore<T>*>(mSharedStores[getComponentTypeID<Shared<T>>()].get())};
+    assert(handle.getGeneration() == mSharedGeneration && "ERROR: shared component handle is from before the manager was cleared.");
+    assert(store != nullptr && handle.getIndex() < store->mValues.size() && "ERROR: invalid shared component handle.");
+    return store->mValues[handle.getIndex()];
+}
+
+// number of distinct values of T
+template<typename T> std::size_t getSharedCount() const noexcept
+{
+    auto* store{static_cast<const SharedStore<T>*>(mSharedStores[getComponentTypeID<Shared<T>>()].get())};
+    return store == nullptr ? 0u : store->mValues.size();
+}
+
+// == WORLDS ==
+// every manager is an independent world, entities (with all their components and groups)
+// can be moved between them; they get new ids in the destination, the old ones stop resolving
+// heap components move as they are (same objects, pointers to them stay valid)
+// relations survive a merge, a single migration drops them; observers see Remove/Add
+
+// move one live entity to 'destination', returns its new id (nullEntity if it does not exist)
+EntityID migrate(EntityID id, EntityManager& destination)
+{
+    auto* entity{getEntity(id)};
+    if(entity == nullptr || !entity->isAlive() || &destination == this) return nullEntity;
+    entity->sweepComponents();
+
+    auto it{std::find_if(mEntityContainer.begin(), mEntityContainer.end(),
+    [entity](const std::unique_ptr<Entity>& e)
+    {
+        return e.get() == entity;
+    })};
+    std::unique_ptr<Entity> moved{std::move(*it)};
+    mEntityContainer.erase(it);
+
+    auto groups{entity->mGroupBitset | mStaleGroups};
+    for(GroupID group{0u}; group < maxGroups; ++group)
+    {
+        if(!groups[group]) continue;
+        auto& eV{mGroupedEntities[group]};
+        eV.erase(std::remove(eV.begin(), eV.end(), entity), eV.end());
+    }
+    releaseRelations(id);
+    for(auto* query : mCachedQueries) query->drop(*entity);
+    for(auto& group : mOwningGroups) leaveOwningGroup(group, id);
+    notifyAll(ObserverEvent::Remove, *entity);
+
+    auto newID{destination.acquireID()};
+    for(ComponentID type{0u}; type < maxComponents; ++type)
+    {
+        auto* pool{mComponentPools[type].get()};
+        if(!entity->mComponentBitset[type] || pool == nullptr) continue;
+        pool->copyOne(id, destination.ensurePool(type, *pool), newID);
+        pool->remove(id);
+    }
+    abandonSlot(id);
+
+    destination.adoptEntity(std::move(moved), newID);
+    destination.signatureChanged(*entity);
+    for(ComponentID type{0u}; type < maxComponents; ++type)
+    {
+        if(mSharedStores[type] && entity->mComponentBitset[type]) mSharedStores[type]->remapInto(destination, &newID, 1u);
+    }
+    destination.notifyAll(ObserverEvent::Add, *entity);
+    return newID;
+}
+
+// move every entity of 'source' into this manager in one go: pooled columns are appended
+// whole, relations between the moved entities are kept, 'source' is left empty
+// (e.g. build a level in a staging world on another thread, then merge it on the main one)
+void merge(EntityManager& source)
+{
+    if(&source == this) return;
+    source.refresh();
+    source.flushObservers();
+    for(auto* query : source.mCachedQueries) query->reset();
+    for(auto& group : source.mOwningGroups) group.mSize = 0u;
+
+    // 1. entities, translated to fresh ids here
+    std::vector<EntityID> newIDs(source.mEntityLookup.size(), nullEntity);
+    std::vector<EntityID> moved;
+    moved.reserve(source.mEntityContainer.size());
+    mEntityContainer.reserve(mEntityContainer.size() + source.mEntityContainer.size());
+    for(auto& entity : source.mEntityContainer)
+    {
+        auto oldID{entity->mID};
+        source.notifyAll(ObserverEvent::Remove, *entity);
+        source.abandonSlot(oldID);
+        auto id{acquireID()};
+        adoptEntity(std::move(entity), id);
+        newIDs[getEntityIndex(oldID)] = id;
+        moved.emplace_back(id);
+    }
+    source.mEntityContainer.clear();
+    for(auto& group : source.mGroupedEntities) group.clear();
+    source.mStaleGroups.reset();
+
+    // 2. pooled columns
+    for(ComponentID type{0u}; type < maxComponents; ++type)
+    {
+        auto* pool{source.mComponentPools[type].get()};
+        if(pool == nullptr || pool->size() == 0u) continue;
+        pool->mergeInto(ensurePool(type, *pool), newIDs);
+        pool->clear();
+    }
+    for(auto& store : source.mSharedStores)
+    {
+        if(store) store->remapInto(*this, moved.data(), moved.size());
+    }
+
+    // 3. relations
+    for(std::size_t kind{0u}; kind < relationCount; ++kind)
+    {
+        auto& targets{source.mRelations[kind].mTargets};
+        for(std::size_t index{0u}; index < targets.size(); ++index)
+        {
+            if(targets[index] != nullEntity) relate(newIDs[index], static_cast<Relation>(kind), newIDs[getEntityIndex(targets[index])]);
+        }
+        source.mRelations[kind] = RelationStore{};
+    }
+
+    for(auto id : moved)
+    {
+        signatureChanged(*getEntity(id));
+        notifyAll(ObserverEvent::Add, *getEntity(id));
+    }
+}
+
+// == RESOURCES ==
+// typed singletons (timers, rng, settings, ...) stored once, outside of any entity
+// they survive clear() since they are not part of the world's entities
+
+// create or replace the resource of type T
+template<typename T, typename... TArgs> T& addResource(TArgs&&... mArgs)
+{
+    auto id{getResourceTypeID<T>()};
+    assert((mActiveAccess == nullptr || mActiveAccess->mWriteResources[id]) && "ERROR: resource written without declared write access.");
+    auto* holder{new ResourceHolder<T>(std::forward<TArgs>(mArgs)...)};
+    mResources[id].reset(holder);
+    return holder->mValue;
+}
+
+// write access (a default constructed resource is created on first use)
+template<typename T> T& resource()
+{
+    auto id{getResourceTypeID<T>()};
+    assert((mActiveAccess == nullptr || mActiveAccess->mWriteResources[id]) && "ERROR: resource written without declared write access.");
+    auto& slot{mResources[id]};
+    if constexpr(std::is_default_constructible<T>::value)
+    {
+        if(!slot) slot.reset(new ResourceHolder<T>());
+    }
+    assert(slot && "ERROR: resource does not exist.");
+    return static_cast<ResourceHolder<T>*>(slot.get())->mValue;
+}
+
+template<typename T> const T& readResource() const
+{
+    auto id{getResourceTypeID<T>()};
+    assert((mActiveAccess == nullptr || mActiveAccess->mReadResources[id] || mActiveAccess->mWriteResources[id])
+           && "ERROR: resource read without declared access.");
+    assert(mResources[id] && "ERROR: resource does not exist.");
+    return static_cast<const ResourceHolder<T>*>(mResources[id].get())->mValue;
+}
+
+template<typename T> bool hasResource() const noexcept { return mResources[getResourceTypeID<T>()] != nullptr; }
+template<typename T> void removeResource() { mResources[getResourceTypeID<T>()].reset(); }
+
+// the access of the system that is running right now (nullptr = unchecked)
+void setSystemAccess(const SystemAccess* access) noexcept { mActiveAccess = access; }
+const SystemAccess* getSystemAccess() const noexcept { return mActiveAccess; }
+
+// == OBSERVERS ==
+// callback(manager, ids, count) for every component of type T that was added, set
+// (Entity::setComponent/touchComponent) or removed (also by destroying its entity)
+// events are not delivered right away but batched until the next sync point: flushObservers(),
+// which updateManager() calls after sweeping dead entities
+// on remove the component (and often its entity) is gone by the time the callback runs
+// bulk column writes (snapshot loads, rollback restores) bypass observers
+template<typename T> void observe(ObserverEvent event, ObserverCallback callback)
+{
+    auto id{getComponentTypeID<T>()};
+    auto index{static_cast<std::size_t>(event)};
+    mObservers[id][index].emplace_back(std::move(callback));
+    mObserved[index][id] = true;
+}
+
+void notify(ObserverEvent event, ComponentID type, EntityID id)
+{
+    if(mObserved[static_cast<std::size_t>(event)][type]) mObserverQueues[type].push_back({id, event});
+}
+
+// deliver the queued events: per component type in the order they happened,
+// consecutive events of one kind in a single call
+// (events raised by the callbacks wait for the next flush)
+void flushObservers()
+{
+    for(ComponentID type{0u}; type < maxComponents; ++type)
+    {
+        if(mObserverQueues[type].empty()) continue;
+
+        auto& records{mObserverScratch};
+        records.clear();
+        std::swap(records, mObserverQueues[type]);
+
+        auto& run{mObserverRun};
+        for(std::size_t first{0u}; first < records.size();)
+        {
+            auto event{records[first].mEvent};
+            run.clear();
+            auto last{first};
+            for(; last < records.size() && records[last].mEvent == event; ++last) run.emplace_back(records[last].mID);
+
+            for(auto& callback : mObservers[type][static_cast<std::size_t>(event)]) callback(*this, run.data(), run.size());
+            first = last;
+        }
+
+        // hand the buffer back so its capacity is reused
+        records.clear();
+        if(mObserverQueues[type].empty()) std::swap(records, mObserverQueues[type]);
+    }
+}
+
+// == EVENTS ==
+// typed, frame scoped event channels for high volume events (collisions, damage, ...)
+// emit() only appends to the channel's buffer, flushEvents() (called by updateManager()
+// after the observers) hands every handler all events of a type at once, in emit order
+// events emitted while nobody listens are dropped
+// (handlers receive a span, copy what has to outlive the call)
+template<typename T> void subscribe(std::function<void(EntityManager& manager, EventSpan<T> events)> handler)
+{
+    getEventChannel<T>().mHandlers.emplace_back(std::move(handler));
+}
+
+template<typename T, typename... TArgs> void emit(TArgs&&... mArgs)
+{
+    auto& channel{getEventChannel<T>()};
+    if(channel.mHandlers.empty()) return;
+    if constexpr(std::is_constructible<T, TArgs...>::value) channel.mPending.emplace_back(std::forward<TArgs>(mArgs)...);
+    else channel.mPending.push_back(T{std::forward<TArgs>(mArgs)...});
+}
+
+template<typename T> void emit(const T* events, std::size_t count)
+{
+    auto& channel{getEventChannel<T>()};
+    if(channel.mHandlers.empty()) return;
+    channel.mPending.insert(channel.mPending.end(), events, events + count);
+}
+
+template<typename T> std::size_t getPendingEventCount() const noexcept
+{
+    const auto& channel{mEventChannels[getEventTypeID<T>()]};
+    return channel ? static_cast<const EventChannel<T>*>(channel.get())->mPending.size() : 0u;
+}
+
+// deliver the pending events of every type (by event type id), buffers are recycled
+void flushEvents()
+{
+    for(auto& channel : mEventChannels)
+    {
+        if(channel) channel->dispatch(*this);
+    }
+}
+
+// throw away undelivered events, e.g. after a rollback restore
+void discardEvents() noexcept
+{
+    for(auto& channel : mEventChannels)
+    {
+        if(channel) channel->discard();
+    }
+}
+
+// == CHANGE TRACKING ==
+std::uint32_t getChangeTick() const noexcept { return mChangeTick; }
+std::uint32_t getStructureTick() const noexcept { return mStructureTick; }
+void markStructureChanged() noexcept { mStructureTick = mChangeTick; }
+
+// start a new tick, changes made from now on compare greater than everything before
+void advanceChangeTick() noexcept
+{
+    ++mChangeTick;
+    for(auto& pool : mComponentPools)
+    {
+        if(pool) pool->setChangeTick(mChangeTick);
+    }
+}
+
+// entities owning all of Ts..., see Query
+template<typename... Ts> Query<Ts...> query() { return Query<Ts...>{*this}; }
+
+// call when a system starts: returns the tick its changed/added filters should look past
+// and remembers the current one in 'lastRun' (changes from now on, including the
+// system's own, are seen by its next run)
+std::uint32_t beginSystemRun(std::uint32_t& lastRun) noexcept
+{
+    auto since{lastRun};
+    lastRun = mChangeTick;
+    advanceChangeTick();
+    return since;
+}
+
+// the entity has removed heap components to destroy at the next refresh
+void scheduleComponentSweep(EntityID id)
+{
+    mComponentSweep.emplace_back(id);
+    mStructureTick = mChangeTick;
+}
+
+void addToGroup(Entity* entity, GroupID group)
+{
+    mGroupedEntities[group].emplace_back(entity);
+    mStructureTick = mChangeTick;
+}
+
+std::vector<Entity*>& getEntitiesByGroup(GroupID group)
+{
+    return mGroupedEntities[group];
+}
+
+// entity left a group (the group list is swept on the next refresh)
+void removeFromGroup(GroupID group) noexcept
+{
+    mStaleGroups[group] = true;
+    mStructureTick = mChangeTick;
+}
+
+// remove destroyed entities (from groups, pools and the container) without updating anything
+// only groups that held a dead entity or lost a member are swept, the container is compacted in one pass
+void refresh()
+{
+    GroupBitset touched{mStaleGroups};
+    for(auto& entity : mEntityContainer)
+    {
+        if(!entity->isAlive()) touched |= entity->mGroupBitset;
+    }
+
+    for(auto i (0u); i < maxGroups; ++i)
+    {
+        if(!touched[i]) continue;
+        auto& eV{mGroupedEntities[i]};
+
+        eV.erase
+        (std::remove_if(eV.begin(), eV.end(),
+        [i](Entity* entity)
+        {
+            return !entity->isAlive() || !entity->hasGroup(i);
+        }),
+        eV.end());
+    }
+    mStaleGroups.reset();
+
+    for(auto id : mComponentSweep)
+    {
+        if(auto* entity{getEntity(id)}) entity->sweepComponents();
+    }
+    mComponentSweep.clear();
+
+    // free the ids and pooled components of dead entities, move the live ones down over them
+    std::size_t kept{0u};
+    for(std::size_t i{0u}; i < mEntityContainer.size(); ++i)
+    {
+        if(!mEntityContainer[i]->isAlive())
+        {
+            releaseEntity(*mEntityContainer[i]);
+            continue;
+        }
+        if(kept != i) mEntityContainer[kept] = std::move(mEntityContainer[i]);
+        ++kept;
+    }
+    mEntityContainer.erase(mEntityContainer.begin() + kept, mEntityContainer.end());
+}
+
+// == BATCH DESTRUCTION ==
+// the entities are only marked dead, the next refresh() sweeps them all in one pass
+// (so both are safe to call from a component update, mid updateManager())
+
+// destroy every entity of a group
+void destroyAll(GroupID group)
+{
+    for(auto* entity : mGroupedEntities[group])
+    {
+        if(entity->hasGroup(group)) entity->destroyObj();
+    }
+}
+
+// destroy every entity that owns all of Ts... and for which predicate(const Ts&...) is true
+template<typename... Ts, typename F> void destroyWhere(F&& predicate)
+{
+    static_assert(sizeof...(Ts) > 0u && "ERROR: destroyWhere needs at least one component type.");
+
+    ComponentBitset signature;
+    (signature.set(getComponentTypeID<Ts>()), ...);
+
+    for(auto& entity : mEntityContainer)
+    {
+        if(!entity->isAlive() || (entity->mComponentBitset & signature) != signature) continue;
+        if(predicate(entity->template readComponent<Ts>()...)) entity->destroyObj();
+    }
+}
+
+// main loop functions
+void updateManager(const float& dt)
+{
+    refresh();
+    flushObservers();
+    flushEvents();
+
+    // update all entities in container
+    for(auto& entity : mEntityContainer)
+    {
+        entity->updateObj(dt);
+    }
+
+    //std::cout << "no. of entities: " << mEntityContainer.size() <<  std::endl;
+
+}
+
+void renderManager(sf::RenderWindow& targetWin)
+{
+    for(auto& entity : mEntityContainer)
+    {
+        entity->renderObj(targetWin);
+    }
+}
+
+};
+
+// == QUERIES ==
+// every live entity owning all of Ts... (enabled, unless includeDisabled()), handed to visit(entity, components...)
+// const types are read (readComponent), the others are mutable and count as a change
+// changed<T>() / added<T>() narrow it down to components written / added after since():
+// changes are tracked per chunk, so changed<T>() may also let through untouched neighbours,
+// added<T>() is exact; the first filtered type drives the iteration, so only its changed part is walked
+// (do not add or remove components of the queried types while iterating)
+template<typename... Ts>
+class Query
+{
+private:
+EntityManager& mManager;
+ComponentBitset mSignature {};
+ComponentBitset mChanged {};
+ComponentBitset mAdded {};
+std::uint32_t mSince{0u};
+bool mIncludeDisabled{false};
+
+bool passes(const Entity& entity) const
+{
+    if(!entity.isAlive()) return false;
+    auto signature{mIncludeDisabled ? entity.getSignature() : entity.getEnabledSignature()};
+    if((signature & mSignature) != mSignature) return false;
+
+    auto filtered{mChanged | mAdded};
+    for(ComponentID type{0u}; type < maxComponents && filtered.any(); ++type)
+    {
+        if(!filtered[type]) continue;
+        filtered[type] = false;
+
+        auto* pool{mManager.getPool(type)};
+        auto pos{pool->indexOf(entity.getID())};
+        if(mChanged[type] && pool->getChunkTick(pos / BaseComponentPool::chunkSize) <= mSince) return false;
+        if(mAdded[type] && pool->getAddedTick(pos) <= mSince) return false;
+    }
+    return true;
+}
+
+template<typename T> static decltype(auto) fetch(Entity& entity)
+{
+    if constexpr(std::is_const<T>::value) return entity.readComponent<std::remove_const_t<T>>();
+    else return entity.getComponent<T>();
+}
+
+template<typename T> static constexpr void checkFilterable()
+{
+    static_assert(isPooledComponent<T> && !isTagComponent<T> && "ERROR: only pooled data components track changes.");
+}
+
+public:
+Query(EntityManager& manager) : mManager{manager}
+{
+    (mSignature.set(getComponentTypeID<std::remove_const_t<Ts>>()), ...);
+}
+
+template<typename T> Query& changed()
+{
+    checkFilterable<T>();
+    mChanged.set(getComponentTypeID<T>());
+    mSignature.set(getComponentTypeID<T>());
+    return *this;
+}
+
+template<typename T> Query& added()
+{
+    checkFilterable<T>();
+    mAdded.set(getComponentTypeID<T>());
+    mSignature.set(getComponentTypeID<T>());
+    return *this;
+}
+
+Query& since(std::uint32_t tick) noexcept
+{
+    mSince = tick;
+    return *this;
+}
+
+// also visit entities whose queried components are disabled
+Query& includeDisabled() noexcept
+{
+    mIncludeDisabled = true;
+    return *this;
+}
+
+template<typename F> void each(F&& visit)
+{
+    auto filtered{mChanged | mAdded};
+    if(filtered.none())
+    {
+        for(auto& entity : mManager.getEntities())
+        {
+            if(passes(*entity)) visit(*entity, fetch<Ts>(*entity)...);
+        }
+        return;
+    }
+
+    ComponentID driver{0u};
+    while(!filtered[driver]) ++driver;
+    auto* pool{mManager.getPool(driver)};
+    if(pool == nullptr) return;
+
+    const auto* owners{pool->owners()};
+    for(std::size_t chunk{0u}; chunk < pool->getChunkCount(); ++chunk)
+    {
+        if(mChanged[driver] && pool->getChunkTick(chunk) <= mSince) continue;
+
+        auto end{std::min(pool->size(), (chunk + 1u) * BaseComponentPool::chunkSize)};
+        for(auto pos{chunk * BaseComponentPool::chunkSize}; pos < end; ++pos)
+        {
+            if(mAdded[driver] && pool->getAddedTick(pos) <= mSince) continue;
+            auto* entity{mManager.getEntity(owners[pos])};
+            if(entity != nullptr && passes(*entity)) visit(*entity, fetch<Ts>(*entity)...);
+        }
+    }
+}
+};
+
+// == CACHED QUERIES ==
+// a persistent Query: the matching entities are tracked as signatures change, so running it
+// costs nothing up front, however often and however many of them there are
+// (enabled bits are not structural, those are checked while iterating; keep it alive
+// as long as the system using it, it unregisters itself when destroyed)
+template<typename... Ts>
+class CachedQuery : public BaseCachedQuery
+{
+private:
+static ComponentBitset makeSignature()
+{
+    ComponentBitset signature;
+    (signature.set(getComponentTypeID<std::remove_const_t<Ts>>()), ...);
+    return signature;
+}
+
+template<typename T> static decltype(auto) fetch(Entity& entity)
+{
+    if constexpr(std::is_const<T>::value) return entity.readComponent<std::remove_const_t<T>>();
+    else return entity.getComponent<T>();
+}
+
+public:
+CachedQuery(EntityManager& manager) : BaseCachedQuery{manager, makeSignature()}
+{
+    manager.registerCachedQuery(*this);
+}
+
+~CachedQuery()
+{
+    if(mManager != nullptr) mManager->unregisterCachedQuery(*this);
+}
+
+// visit(entity, components...) for every live match with all of Ts enabled
+// (do not add/remove components of the queried types or sweep while iterating)
+template<typename F> void each(F&& visit)
+{
+    for(std::size_t i{0u}; i < mMatches.size(); ++i)
+    {
+        auto& entity{*mMatches[i]};
+        if(!entity.isAlive() || (entity.getEnabledSignature() & mSignature) != mSignature) continue;
+        visit(entity, fetch<Ts>(entity)...);
+    }
+}
+
+// matching entities, unordered (also disabled and destroyed-but-not-swept ones)
+const std::vector<Entity*>& getMatches() const noexcept { return mMatches; }
+};
+
+// == OWNING GROUPS ==
+// EnTT style: the group owns the pools of Ts..., entities having all of them are kept packed at
+// the front of every one of those pools in the same order, so each() walks plain arrays side by side
+// (no entity lookups; it also visits disabled and destroyed-but-not-swept members)
+// const types are read, the others are mutable and mark the chunks holding the members as changed
+template<typename... Ts>
+class OwningGroup
+{
+private:
+EntityManager* mManager;
+std::size_t mIndex;
+
+template<typename T> auto column(std::size_t count) const
+{
+    using U = std::remove_const_t<T>;
+    auto& pool{mManager->getPool<U>()};
+    if constexpr(std::is_const<T>::value) return static_cast<const ComponentPool<U>&>(pool).data();
+    else return pool.data(0u, count);
+}
+
+template<typename F, std::size_t... Is> void run(F& visit, std::index_sequence<Is...>) const
+{
+    auto count{size()};
+    if(count == 0u) return;
+
+    // owners of the first pool name the members for all of them
+    using First = std::remove_const_t<std::tuple_element_t<0, std::tuple<Ts...>>>;
+    const auto& firstPool{static_cast<const ComponentPool<First>&>(mManager->getPool<First>())};
+    const EntityID* owners{firstPool.owners()};
+    std::tuple<decltype(column<Ts>(count))...> columns{column<Ts>(count)...};
+    for(std::size_t i{0u}; i < count; ++i) visit(owners[i], std::get<Is>(columns)[i]...);
+}
+
+public:
+OwningGroup(EntityManager& manager, std::size_t index) : mManager{&manager}, mIndex{index} {}
+
+std::size_t size() const noexcept { return mManager->getOwningGroup(mIndex).mSize; }
+
+// visit(id, components...) for every member
+// (do not add/remove components of the owned types or sweep while iterating)
+template<typename F> void each(F&& visit) const
+{
+    run(visit, std::index_sequence_for<Ts...>{});
+}
+};
+
+template<typename... Ts> OwningGroup<Ts...> EntityManager::group()
+{
+    static_assert(sizeof...(Ts) > 0u && "ERROR: a group needs at least one component type.");
+    static_assert(((isPooledComponent<std::remove_const_t<Ts>> && !isTagComponent<std::remove_const_t<Ts>>) && ...)
+                  && "ERROR: groups can only own pooled data components.");
+
+    ComponentBitset owned;
+    (owned.set(getComponentTypeID<std::remove_const_t<Ts>>()), ...);
+    for(std::size_t i{0u}; i < mOwningGroups.size(); ++i)
+    {
+        if(mOwningGroups[i].mOwned == owned) return OwningGroup<Ts...>{*this, i};
+    }
+    assert((owned & mOwnedTypes).none() && "ERROR: a component type can only be owned by one group.");
+
+    (getPool<std::remove_const_t<Ts>>(), ...);
+    OwningGroupState state;
+    state.mOwned = owned;
+    state.mTypes = {getComponentTypeID<std::remove_const_t<Ts>>()...};
+    mOwningGroups.emplace_back(std::move(state));
+    mOwnedTypes |= owned;
+
+    // pack whoever already qualifies
+    auto& group{mOwningGroups.back()};
+    for(auto& entity : mEntityContainer)
+    {
+        if((entity->mComponentBitset & owned) == owned) enterOwningGroup(group, entity->mID);
+    }
+    return OwningGroup<Ts...>{*this, mOwningGroups.size() - 1u};
+}
+
+// declares the access of the system running in the enclosing scope
+class ScopedSystemAccess
+{
+private:
+EntityManager& mManager;
+const SystemAccess* mPrevious;
+
+public:
+ScopedSystemAccess(EntityManager& manager, const SystemAccess& access) : mManager{manager}, mPrevious{manager.getSystemAccess()}
+{
+    mManager.setSystemAccess(&access);
+}
+~ScopedSystemAccess() { mManager.setSystemAccess(mPrevious); }
+};
+
+inline void Entity::addGroup(GroupID group) noexcept
+{
+    mGroupBitset[group] = true;
+    mManager->addToGroup(this,group);
+}
+
+inline void Entity::deleteGroup(GroupID group) noexcept
+{
+    mGroupBitset[group] = false;
+    mManager->removeFromGroup(group);
+}
+
+template<typename T, typename... TArgs>
+T& Entity::addPooledComponent(TArgs&&... mArgs)
+{
+    // (stored before the signature changes, an owning group may move it right away)
+    auto& pool{mManager->getPool<T>()};
+    pool.emplace(mID, std::forward<TArgs>(mArgs)...);
+    mComponentBitset[getComponentTypeID<T>()] = true;
+    mManager->signatureChanged(*this);
+    mManager->notify(ObserverEvent::Add, getComponentTypeID<T>(), mID);
+    return pool.get(mID);
+}
+
+inline void Entity::notifyManager(ObserverEvent event, ComponentID type)
+{
+    mManager->notify(event, type, mID);
+}
+
+template<typename T>
+Shared<T> Entity::shareValue(const T& value)
+{
+    return mManager->share(value);
+}
+
+template<typename T>
+const T& Entity::resolveShared(Shared<T> handle) const
+{
+    return mManager->getShared(handle);
+}
+
+inline void Entity::removePooledComponent(ComponentID type)
+{
+    mManager->getPool(type)->remove(mID);
+    mManager->markStructureChanged();
+}
+
+inline void Entity::signatureChanged()
+{
+    mManager->signatureChanged(*this);
+}
+
+inline void Entity::scheduleComponentSweep()
+{
+    mManager->scheduleComponentSweep(mID);
+}
+
+template<typename T>
+T& Entity::getPooledComponent() const
+{
+    assert(hasComponent<T>() && "ERROR: Component does not exist.");
+    return mManager->getPool<T>().get(mID);
+}
+
+template<typename T>
+const T& Entity::readPooledComponent() const
+{
+    assert(hasComponent<T>() && "ERROR: Component does not exist.");
+    const auto& pool{mManager->getPool<T>()};
+    return pool.get(mID);
+}
+
+template<typename T, typename... TArgs>
+Prefab& Prefab::with(TArgs&&... mArgs)
+{
+    auto id{getComponentTypeID<T>()};
+    assert(!mSignature[id] && "ERROR: prefab already has this component.");
+    mSignature[id] = true;
+
+    if constexpr(isTagComponent<T>)
+    {
+        static_assert(sizeof...(TArgs) == 0u && "ERROR: tags take no arguments.");
+        mPooledSignature[id] = true;
+    }
+    else if constexpr(isPooledComponent<T>)
+    {
+        // build the default value once, instances are copies of it
+        const T* value{nullptr};
+        if constexpr(std::is_constructible<T, TArgs...>::value) value = new T(std::forward<TArgs>(mArgs)...);
+        else value = new T{std::forward<TArgs>(mArgs)...};
+
+        PooledDefault entry;
+        entry.mValue = std::shared_ptr<const T>{value};
+        entry.spawn = [](EntityManager& manager, const void* value, const EntityID* ids, std::size_t count)
+        {
+            manager.getPool<T>().fill(ids, count, *static_cast<const T*>(value));
+        };
+        mPooled.emplace_back(std::move(entry));
+        mPooledSignature[id] = true;
+    }
+    else
+    {
+        mHeap.emplace_back([mArgs...](Entity& entity) { entity.addComponent<T>(mArgs...); });
+    }
+    return *this;
+}
+
+#endif // ECS_H
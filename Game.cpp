@@ -1,4 +1,5 @@
 #include "Game.hpp"
+#include "Replay.hpp"
 
 // == PRIVATE ==
 
@@ -6,6 +7,7 @@
 void Game::initVars()
 {
     this->mainWindow = nullptr;
+    this->replayRecorder = nullptr;
     this->endGame = false;
 }
 
@@ -70,6 +72,11 @@ float Game::getTimeElapsedMilliseconds()
     return this->clock.getElapsedTime().asMilliseconds();
 }
 
+void Game::setReplayRecorder(ReplayRecorder* recorder)
+{
+    this->replayRecorder = recorder;
+}
+
 // == GAME LOOP FUNCTIONS ==
 // get system events 
 void Game::pollEvents()
@@ -78,6 +85,8 @@ void Game::pollEvents()
     // (we pass in an sf::Event variable)
     while(this->mainWindow->pollEvent(ev))
     {
+        if(this->replayRecorder != nullptr) this->replayRecorder->recordEvent(ev);
+
         // check for event type
         switch(ev.type)
         {
@@ -10,6 +10,8 @@
 #include <SFML/Window.hpp>
 #include <SFML/Audio.hpp>
 
+class ReplayRecorder;
+
 class Game
 {
 
@@ -19,6 +21,7 @@ private:
     sf::VideoMode videoMode;
     // == EVENT VARIABLES ==
     sf::Event ev;
+    ReplayRecorder* replayRecorder;
     // == TIME VARIABLES ==
     sf::Clock clock;
     // == GAME OBJECTS ==
@@ -50,6 +53,9 @@ private:
     float getTimeElapsedSeconds();
     float getTimeElapsedMilliseconds();
 
+    // polled events are logged to the recorder (nullptr to stop)
+    void setReplayRecorder(ReplayRecorder* recorder);
+
     // == GAME LOOP FUNCTIONS ==
     void pollEvents();
     void updateUIText(float dt);
@@ -0,0 +1,163 @@
+#include "Interpolation.hpp"
+
+#include <cmath>
+
+// playback further than this off its target is reset instead of slowly corrected
+constexpr float interpolationSnapDistance{1.0f};
+// the playback clock speed may deviate this much to catch up / fall back
+constexpr float interpolationMaxDrift{0.1f};
+
+void SnapshotInterpolator::sortByID(TransformColumns& transforms)
+{
+    if(std::is_sorted(transforms.mIDs.begin(), transforms.mIDs.end())) return;
+
+    auto& order{this->mOrder};
+    order.resize(transforms.size());
+    for(std::uint32_t i{0u}; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(),
+    [&transforms](std::uint32_t a, std::uint32_t b)
+    {
+        return transforms.mIDs[a] < transforms.mIDs[b];
+    });
+
+    auto& sorted{this->mSorted};
+    sorted.clear();
+    for(auto i : order) sorted.push(transforms.mIDs[i], transforms.mX[i], transforms.mY[i], transforms.mRotation[i]);
+    std::swap(sorted, transforms);
+}
+
+bool SnapshotInterpolator::push(float time, const TransformColumns& transforms)
+{
+    auto& snapshots{this->mSnapshots};
+    if(this->mCount != 0u && time <= snapshots[0].mTime && this->mCount == snapshots.size()) return false;
+
+    // position in time order
+    std::size_t position{this->mCount};
+    while(position > 0u && snapshots[position - 1u].mTime >= time) --position;
+    if(position < this->mCount && snapshots[position].mTime == time) return false;
+
+    // full: the oldest buffer gets recycled
+    if(this->mCount == snapshots.size())
+    {
+        std::rotate(snapshots.begin(), snapshots.begin() + 1, snapshots.end());
+        --this->mCount;
+        --position;
+    }
+
+    // fill the first spare buffer, then move it into place (swaps vectors, no copies)
+    auto& slot{snapshots[this->mCount]};
+    slot.mTime = time;
+    slot.mTransforms.mIDs.assign(transforms.mIDs.begin(), transforms.mIDs.end());
+    slot.mTransforms.mX.assign(transforms.mX.begin(), transforms.mX.end());
+    slot.mTransforms.mY.assign(transforms.mY.begin(), transforms.mY.end());
+    slot.mTransforms.mRotation.assign(transforms.mRotation.begin(), transforms.mRotation.end());
+    this->sortByID(slot.mTransforms);
+
+    std::rotate(snapshots.begin() + position, snapshots.begin() + this->mCount, snapshots.begin() + this->mCount + 1);
+    ++this->mCount;
+    return true;
+}
+
+void SnapshotInterpolator::clear()
+{
+    this->mCount = 0u;
+    this->mStarted = false;
+    this->mPlaybackTime = 0.0f;
+}
+
+void SnapshotInterpolator::advance(float dt)
+{
+    if(this->mCount == 0u) return;
+
+    float target{this->mSnapshots[this->mCount - 1u].mTime - this->mDelay};
+    if(!this->mStarted || std::abs(target - this->mPlaybackTime) > interpolationSnapDistance)
+    {
+        this->mPlaybackTime = target;
+        this->mStarted = true;
+        return;
+    }
+
+    float error{target - this->mPlaybackTime};
+    float rate{1.0f + std::min(std::max(error * 2.0f, -interpolationMaxDrift), interpolationMaxDrift)};
+    this->mPlaybackTime += dt * rate;
+}
+
+void SnapshotInterpolator::blend(const TransformColumns& from, const TransformColumns& to, float alpha, TransformColumns& out)
+{
+    // 1. line the older snapshot up with the newer one (both sorted by id)
+    //    entities that just appeared start from their new transform, vanished ones are dropped
+    auto count{to.size()};
+    this->mFromX.resize(count);
+    this->mFromY.resize(count);
+    this->mFromRotation.resize(count);
+
+    std::size_t f{0u};
+    for(std::size_t i{0u}; i < count; ++i)
+    {
+        while(f < from.size() && from.mIDs[f] < to.mIDs[i]) ++f;
+        bool matched{f < from.size() && from.mIDs[f] == to.mIDs[i]};
+        this->mFromX[i] = matched ? from.mX[f] : to.mX[i];
+        this->mFromY[i] = matched ? from.mY[f] : to.mY[i];
+        // the rotation is unwrapped so it turns the short way round
+        float turn{matched ? to.mRotation[i] - from.mRotation[f] : 0.0f};
+        turn -= 360.0f * std::floor((turn + 180.0f) / 360.0f);
+        this->mFromRotation[i] = to.mRotation[i] - turn;
+    }
+
+    // 2. blend as one batch over the columns
+    out.mIDs.assign(to.mIDs.begin(), to.mIDs.end());
+    out.mX.resize(count);
+    out.mY.resize(count);
+    out.mRotation.resize(count);
+
+    const float* fromX{this->mFromX.data()};
+    const float* fromY{this->mFromY.data()};
+    const float* fromRotation{this->mFromRotation.data()};
+    const float* toX{to.mX.data()};
+    const float* toY{to.mY.data()};
+    const float* toRotation{to.mRotation.data()};
+    float* outX{out.mX.data()};
+    float* outY{out.mY.data()};
+    float* outRotation{out.mRotation.data()};
+    for(std::size_t i{0u}; i < count; ++i)
+    {
+        outX[i] = fromX[i] + (toX[i] - fromX[i]) * alpha;
+        outY[i] = fromY[i] + (toY[i] - fromY[i]) * alpha;
+        outRotation[i] = fromRotation[i] + (toRotation[i] - fromRotation[i]) * alpha;
+    }
+}
+
+bool SnapshotInterpolator::sample(TransformColumns& out)
+{
+    if(this->mCount == 0u) return false;
+
+    auto& snapshots{this->mSnapshots};
+    float time{this->mPlaybackTime};
+
+    // first snapshot past the playback time
+    std::size_t next{0u};
+    while(next < this->mCount && snapshots[next].mTime <= time) ++next;
+
+    if(next == 0u || this->mCount == 1u)
+    {
+        // nothing to blend with yet: hold the closest snapshot
+        auto& only{snapshots[next == 0u ? 0u : this->mCount - 1u].mTransforms};
+        this->blend(only, only, 0.0f, out);
+        return true;
+    }
+
+    if(next == this->mCount)
+    {
+        // ran dry: continue the motion of the last two snapshots, capped
+        auto& a{snapshots[this->mCount - 2u]};
+        auto& b{snapshots[this->mCount - 1u]};
+        float ahead{std::min(time - b.mTime, this->mMaxExtrapolation)};
+        this->blend(a.mTransforms, b.mTransforms, 1.0f + ahead / (b.mTime - a.mTime), out);
+        return true;
+    }
+
+    auto& a{snapshots[next - 1u]};
+    auto& b{snapshots[next]};
+    this->blend(a.mTransforms, b.mTransforms, (time - a.mTime) / (b.mTime - a.mTime), out);
+    return true;
+}
@@ -0,0 +1,94 @@
+#ifndef INTERPOLATION_H
+#define INTERPOLATION_H
+
+#include "ECS.hpp"
+
+// == TRANSFORM COLUMNS ==
+// position/rotation of many entities as separate arrays (structure of arrays),
+// so interpolating them is a plain loop over floats the compiler can vectorize
+struct TransformColumns
+{
+    std::vector<EntityID> mIDs {};
+    std::vector<float> mX {};
+    std::vector<float> mY {};
+    std::vector<float> mRotation {};    // degrees, like sf::Transformable
+
+    void clear()
+    {
+        mIDs.clear();
+        mX.clear();
+        mY.clear();
+        mRotation.clear();
+    }
+
+    void push(EntityID id, float x, float y, float rotation)
+    {
+        mIDs.emplace_back(id);
+        mX.emplace_back(x);
+        mY.emplace_back(y);
+        mRotation.emplace_back(rotation);
+    }
+
+    std::size_t size() const noexcept { return mIDs.size(); }
+};
+
+// == SNAPSHOT INTERPOLATION ==
+// jitter buffer for transforms received from a server: snapshots are kept in time order
+// (late ones are slotted in) and entities are shown at a playback time that trails the newest
+// snapshot by 'delay', so there are usually two snapshots around it to interpolate between
+// if the buffer runs dry, motion is extrapolated from the last two snapshots, for at most 'maxExtrapolation'
+// the playback clock runs slightly faster/slower to keep the delay, and snaps if it is far off
+// snapshot buffers are reused, so once the ring has filled up nothing is allocated
+class SnapshotInterpolator
+{
+private:
+struct Snapshot
+{
+    float mTime{0.0f};
+    TransformColumns mTransforms {};
+};
+
+std::vector<Snapshot> mSnapshots;   // [0, mCount) in time order, the rest are spare buffers
+std::size_t mCount{0u};
+
+float mDelay{0.1f};
+float mMaxExtrapolation{0.25f};
+float mPlaybackTime{0.0f};
+bool mStarted{false};
+
+// scratch: values of the older snapshot lined up with the newer one
+std::vector<float> mFromX {};
+std::vector<float> mFromY {};
+std::vector<float> mFromRotation {};
+std::vector<std::uint32_t> mOrder {};
+TransformColumns mSorted {};
+
+void sortByID(TransformColumns& transforms);
+void blend(const TransformColumns& from, const TransformColumns& to, float alpha, TransformColumns& out);
+
+public:
+SnapshotInterpolator(std::size_t capacity = 32u) : mSnapshots(capacity)
+{
+    assert(capacity >= 2u && "ERROR: interpolation needs room for at least two snapshots.");
+}
+
+void setDelay(float delay) noexcept { mDelay = delay; }
+void setMaxExtrapolation(float seconds) noexcept { mMaxExtrapolation = seconds; }
+
+// store the transforms the server had at 'time' (its clock, e.g. tick * tick length)
+// false if it is older than everything buffered, or a duplicate
+bool push(float time, const TransformColumns& transforms);
+void clear();
+
+// advance the playback clock by a frame
+void advance(float dt);
+// transforms at the current playback time (false while nothing has been received)
+bool sample(TransformColumns& out);
+
+float getPlaybackTime() const noexcept { return mPlaybackTime; }
+std::size_t getBufferedCount() const noexcept { return mCount; }
+// how far the newest snapshot is ahead of playback (should hover around the delay)
+float getBufferedTime() const noexcept { return mCount == 0u ? 0.0f : mSnapshots[mCount - 1u].mTime - mPlaybackTime; }
+};
+
+#endif // INTERPOLATION_H
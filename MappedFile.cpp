@@ -0,0 +1,113 @@
+#include "MappedFile.hpp"
+
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+    this->close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path)
+{
+    this->close();
+
+    HANDLE file{CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr)};
+    if(file == INVALID_HANDLE_VALUE)
+    {
+        std::cerr << "ERROR: could not open '" << path << "' for mapping." << std::endl;
+        return false;
+    }
+    this->mFileHandle = file;
+
+    LARGE_INTEGER size;
+    if(!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        this->close();
+        return false;
+    }
+
+    HANDLE mapping{CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr)};
+    if(mapping == nullptr)
+    {
+        this->close();
+        return false;
+    }
+    this->mMappingHandle = mapping;
+
+    this->mData = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    this->mSize = static_cast<std::size_t>(size.QuadPart);
+    if(this->mData == nullptr)
+    {
+        this->close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close()
+{
+    if(this->mData != nullptr) UnmapViewOfFile(this->mData);
+    if(this->mMappingHandle != nullptr) CloseHandle(this->mMappingHandle);
+    if(this->mFileHandle != nullptr) CloseHandle(this->mFileHandle);
+
+    this->mData = nullptr;
+    this->mSize = 0u;
+    this->mMappingHandle = nullptr;
+    this->mFileHandle = nullptr;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path)
+{
+    this->close();
+
+    this->mFileDescriptor = ::open(path.c_str(), O_RDONLY);
+    if(this->mFileDescriptor < 0)
+    {
+        std::cerr << "ERROR: could not open '" << path << "' for mapping." << std::endl;
+        return false;
+    }
+
+    struct stat info;
+    if(fstat(this->mFileDescriptor, &info) != 0 || info.st_size == 0)
+    {
+        this->close();
+        return false;
+    }
+
+    void* address{mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_SHARED, this->mFileDescriptor, 0)};
+    if(address == MAP_FAILED)
+    {
+        this->close();
+        return false;
+    }
+
+    this->mData = static_cast<const char*>(address);
+    this->mSize = static_cast<std::size_t>(info.st_size);
+    return true;
+}
+
+void MappedFile::close()
+{
+    if(this->mData != nullptr) munmap(const_cast<char*>(this->mData), this->mSize);
+    if(this->mFileDescriptor >= 0) ::close(this->mFileDescriptor);
+
+    this->mData = nullptr;
+    this->mSize = 0u;
+    this->mFileDescriptor = -1;
+}
+
+#endif
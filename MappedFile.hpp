@@ -0,0 +1,36 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <cstddef>
+
+#include <SFML/System/NonCopyable.hpp>
+
+// read-only memory mapping of a whole file
+// (pages are faulted in lazily by the OS and shared between every process mapping the same file)
+class MappedFile : sf::NonCopyable
+{
+private:
+const char* mData{nullptr};
+std::size_t mSize{0u};
+
+#ifdef _WIN32
+void* mFileHandle{nullptr};
+void* mMappingHandle{nullptr};
+#else
+int mFileDescriptor{-1};
+#endif
+
+public:
+MappedFile() {}
+~MappedFile();
+
+bool open(const std::string& path);
+void close();
+
+bool isOpen() const noexcept { return mData != nullptr; }
+const char* data() const noexcept { return mData; }
+std::size_t size() const noexcept { return mSize; }
+};
+
+#endif // MAPPEDFILE_H
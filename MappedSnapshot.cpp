@@ -0,0 +1,233 @@
+#include "MappedSnapshot.hpp"
+
+#include <fstream>
+
+constexpr std::uint32_t mappedSnapshotMagic{0x4D4C4F56u}; // "VOLM"
+constexpr std::uint32_t mappedSnapshotVersion{3u};
+
+// does [offset, offset + count * elementSize) lie inside a buffer of 'size' bytes
+static bool rangeFits(std::uint64_t offset, std::uint64_t count, std::uint64_t elementSize, std::size_t size)
+{
+    if(offset > size || (elementSize != 0u && count > (size - offset) / elementSize)) return false;
+    return true;
+}
+
+// == SAVE ==
+bool saveMappedSnapshot(const EntityManager& manager, const SnapshotRegistry& registry, const std::string& path)
+{
+    auto& entries{registry.getEntries()};
+    auto& entities{manager.getEntities()};
+
+    std::vector<char> buffer;
+    BinaryWriter out{buffer};
+
+    // 1. header + type table are written as placeholders and patched at the end
+    MappedSnapshotHeader header{};
+    header.mMagic = mappedSnapshotMagic;
+    header.mVersion = mappedSnapshotVersion;
+    header.mHeaderSize = sizeof(MappedSnapshotHeader);
+    header.mTypeCount = static_cast<std::uint32_t>(entries.size());
+    header.mEntityCount = entities.size();
+    out.write(header);
+
+    out.align(mappedSnapshotAlignment);
+    header.mTypeTableOffset = out.size();
+    std::vector<MappedColumnEntry> table(entries.size(), MappedColumnEntry{});
+    out.writeBytes(table.data(), table.size() * sizeof(MappedColumnEntry));
+
+    // 2. entity ids, group, tag and disabled masks as flat arrays
+    out.align(mappedSnapshotAlignment);
+    header.mEntityIDsOffset = out.size();
+    for(auto& entity : entities) out.write(entity->getID());
+
+    out.align(mappedSnapshotAlignment);
+    header.mEntityGroupsOffset = out.size();
+    for(auto& entity : entities) out.write(static_cast<std::uint32_t>(entity->getGroups().to_ulong()));
+
+    out.align(mappedSnapshotAlignment);
+    header.mEntityTagsOffset = out.size();
+    for(auto& entity : entities) out.write(registry.getTagMask(*entity));
+
+    out.align(mappedSnapshotAlignment);
+    header.mEntityDisabledOffset = out.size();
+    for(auto& entity : entities) out.write(registry.getDisabledMask(*entity));
+
+    // 3. heap components, serialized in entity order
+    out.align(mappedSnapshotAlignment);
+    header.mHeapOffset = out.size();
+    for(auto& entity : entities) writeHeapComponents(*entity, registry, out);
+    header.mHeapSize = out.size() - header.mHeapOffset;
+
+    // 4. one aligned owner array + data block per pooled column
+    for(std::size_t i{0u}; i < entries.size(); ++i)
+    {
+        auto& entry{entries[i]};
+        auto& column{table[i]};
+        if(entry.mName.size() >= mappedColumnNameLength)
+        {
+            std::cerr << "ERROR: component name '" << entry.mName << "' is too long for a mapped snapshot." << std::endl;
+            return false;
+        }
+        std::memcpy(column.mName, entry.mName.c_str(), entry.mName.size() + 1u);
+        column.mRawSize = entry.mRawSize;
+        column.mKind = entry.getKind();
+
+        auto* pool{manager.getPool(entry.mTypeID)};
+        if(!entry.mPooled || pool == nullptr || pool->size() == 0u) continue;
+
+        column.mCount = pool->size();
+        out.align(mappedSnapshotAlignment);
+        column.mOwnersOffset = out.size();
+        out.writeBytes(pool->owners(), pool->size() * sizeof(EntityID));
+
+        out.align(mappedSnapshotAlignment);
+        column.mDataOffset = out.size();
+        entry.writeColumn(*pool, out);
+        column.mDataSize = out.size() - column.mDataOffset;
+    }
+
+    out.patch(0u, header);
+    std::memcpy(buffer.data() + header.mTypeTableOffset, table.data(), table.size() * sizeof(MappedColumnEntry));
+
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    return static_cast<bool>(file);
+}
+
+// == OPEN/VALIDATE ==
+bool MappedSnapshot::open(const std::string& path)
+{
+    this->close();
+    if(!this->mFile.open(path)) return false;
+
+    if(this->mFile.size() < sizeof(MappedSnapshotHeader))
+    {
+        std::cerr << "ERROR: '" << path << "' is not a mapped snapshot." << std::endl;
+        this->close();
+        return false;
+    }
+
+    this->mHeader = reinterpret_cast<const MappedSnapshotHeader*>(this->mFile.data());
+    this->mColumns = reinterpret_cast<const MappedColumnEntry*>(this->mFile.data() + this->mHeader->mTypeTableOffset);
+    if(!this->validate())
+    {
+        std::cerr << "ERROR: '" << path << "' is not a mapped snapshot, or it is corrupt." << std::endl;
+        this->close();
+        return false;
+    }
+    return true;
+}
+
+void MappedSnapshot::close()
+{
+    this->mHeader = nullptr;
+    this->mColumns = nullptr;
+    this->mFile.close();
+}
+
+bool MappedSnapshot::validate() const
+{
+    // only bounds/alignment are checked here, the data itself is trusted
+    auto size{this->mFile.size()};
+    auto& header{*this->mHeader};
+    if(header.mMagic != mappedSnapshotMagic || header.mVersion != mappedSnapshotVersion || header.mHeaderSize != sizeof(MappedSnapshotHeader))
+    {
+        return false;
+    }
+
+    if(header.mTypeTableOffset % mappedSnapshotAlignment != 0u || !rangeFits(header.mTypeTableOffset, header.mTypeCount, sizeof(MappedColumnEntry), size)
+    || header.mEntityIDsOffset % mappedSnapshotAlignment != 0u || !rangeFits(header.mEntityIDsOffset, header.mEntityCount, sizeof(EntityID), size)
+    || header.mEntityGroupsOffset % mappedSnapshotAlignment != 0u || !rangeFits(header.mEntityGroupsOffset, header.mEntityCount, sizeof(std::uint32_t), size)
+    || header.mEntityTagsOffset % mappedSnapshotAlignment != 0u || !rangeFits(header.mEntityTagsOffset, header.mEntityCount, sizeof(std::uint32_t), size)
+    || header.mEntityDisabledOffset % mappedSnapshotAlignment != 0u || !rangeFits(header.mEntityDisabledOffset, header.mEntityCount, sizeof(std::uint32_t), size)
+    || !rangeFits(header.mHeapOffset, header.mHeapSize, 1u, size))
+    {
+        return false;
+    }
+
+    for(std::uint32_t i{0u}; i < header.mTypeCount; ++i)
+    {
+        auto& column{this->mColumns[i]};
+        if(column.mName[mappedColumnNameLength - 1u] != '\0') return false;
+        if(column.mCount == 0u) continue;
+
+        if(column.mOwnersOffset % mappedSnapshotAlignment != 0u || !rangeFits(column.mOwnersOffset, column.mCount, sizeof(EntityID), size)
+        || column.mDataOffset % mappedSnapshotAlignment != 0u || !rangeFits(column.mDataOffset, column.mDataSize, 1u, size)
+        || (column.mRawSize != 0u && column.mDataSize != column.mCount * column.mRawSize))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// == ACCESS ==
+const EntityID* MappedSnapshot::getEntityIDs() const noexcept
+{
+    if(this->mHeader == nullptr) return nullptr;
+    return reinterpret_cast<const EntityID*>(this->mFile.data() + this->mHeader->mEntityIDsOffset);
+}
+
+const std::uint32_t* MappedSnapshot::getEntityGroups() const noexcept
+{
+    if(this->mHeader == nullptr) return nullptr;
+    return reinterpret_cast<const std::uint32_t*>(this->mFile.data() + this->mHeader->mEntityGroupsOffset);
+}
+
+const std::uint32_t* MappedSnapshot::getEntityTags() const noexcept
+{
+    if(this->mHeader == nullptr) return nullptr;
+    return reinterpret_cast<const std::uint32_t*>(this->mFile.data() + this->mHeader->mEntityTagsOffset);
+}
+
+const std::uint32_t* MappedSnapshot::getEntityDisabled() const noexcept
+{
+    if(this->mHeader == nullptr) return nullptr;
+    return reinterpret_cast<const std::uint32_t*>(this->mFile.data() + this->mHeader->mEntityDisabledOffset);
+}
+
+const MappedColumnEntry* MappedSnapshot::findColumn(const std::string& name) const noexcept
+{
+    if(this->mHeader == nullptr) return nullptr;
+
+    for(std::uint32_t i{0u}; i < this->mHeader->mTypeCount; ++i)
+    {
+        if(name == this->mColumns[i].mName) return &this->mColumns[i];
+    }
+    return nullptr;
+}
+
+// == LOAD ==
+bool MappedSnapshot::loadInto(EntityManager& manager, const SnapshotRegistry& registry) const
+{
+    if(this->mHeader == nullptr) return false;
+    auto& header{*this->mHeader};
+
+    // 1. resolve the type table against the registry
+    std::vector<const SnapshotRegistry::Entry*> types(header.mTypeCount, nullptr);
+    for(std::uint32_t i{0u}; i < header.mTypeCount; ++i)
+    {
+        auto& column{this->mColumns[i]};
+        types[i] = resolveSnapshotType(registry, column.mName, static_cast<std::uint8_t>(column.mKind), column.mRawSize);
+        if(types[i] == nullptr) return false;
+    }
+
+    // 2. every array is used straight out of the mapping
+    std::vector<SnapshotColumnParts> columns(header.mTypeCount, SnapshotColumnParts{nullptr, 0u, nullptr, 0u});
+    for(std::uint32_t i{0u}; i < header.mTypeCount; ++i)
+    {
+        auto& column{this->mColumns[i]};
+        if(column.mCount == 0u) continue;
+
+        columns[i].mOwners = this->mFile.data() + column.mOwnersOffset;
+        columns[i].mCount = static_cast<std::size_t>(column.mCount);
+        columns[i].mData = this->mFile.data() + column.mDataOffset;
+        columns[i].mDataSize = static_cast<std::size_t>(column.mDataSize);
+    }
+
+    bool ok{loadSnapshotParts(manager, types, this->getEntityIDs(), this->getEntityGroups(), this->getEntityTags(),
+                              this->getEntityDisabled(), static_cast<std::size_t>(header.mEntityCount),
+                              this->mFile.data() + header.mHeapOffset, static_cast<std::size_t>(header.mHeapSize), columns)};
+    if(!ok) std::cerr << "ERROR: mapped snapshot is corrupt." << std::endl;
+    return ok;
+}
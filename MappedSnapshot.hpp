@@ -0,0 +1,107 @@
+#ifndef MAPPEDSNAPSHOT_H
+#define MAPPEDSNAPSHOT_H
+
+#include "Snapshot.hpp"
+#include "MappedFile.hpp"
+
+// == MAPPED SNAPSHOT FORMAT ==
+// a snapshot laid out so it can be mmap'ed and used without a parsing step:
+// fixed-size header, a table of column entries holding offsets, then every array
+// (entity ids, group masks, tag masks, pooled component columns) starting on a 64 byte boundary
+// only heap components are stored as a serialized stream, they are rebuilt on loadInto()
+constexpr std::size_t mappedSnapshotAlignment{64};
+constexpr std::size_t mappedColumnNameLength{24};
+
+struct MappedSnapshotHeader
+{
+    std::uint32_t mMagic;
+    std::uint32_t mVersion;
+    std::uint32_t mHeaderSize;          // sizeof(MappedSnapshotHeader), catches layout drift
+    std::uint32_t mTypeCount;
+    std::uint64_t mEntityCount;
+    std::uint64_t mEntityIDsOffset;     // EntityID[mEntityCount]
+    std::uint64_t mEntityGroupsOffset;  // std::uint32_t[mEntityCount]
+    std::uint64_t mTypeTableOffset;     // MappedColumnEntry[mTypeCount]
+    std::uint64_t mHeapOffset;          // heap component stream, in entity order
+    std::uint64_t mHeapSize;
+    std::uint64_t mEntityTagsOffset;    // std::uint32_t[mEntityCount], see SnapshotRegistry::getTagMask
+    std::uint64_t mEntityDisabledOffset;// std::uint32_t[mEntityCount], see SnapshotRegistry::getDisabledMask
+    std::uint64_t mReserved[6];         // zero, keeps the header at two alignment units
+};
+static_assert(sizeof(MappedSnapshotHeader) == 128 && "ERROR: mapped snapshot header layout changed.");
+
+struct MappedColumnEntry
+{
+    char mName[mappedColumnNameLength]; // zero terminated
+    std::uint32_t mRawSize;             // sizeof(T) if the column can be used in place, else 0
+    std::uint32_t mKind;                // SnapshotTypeKind, only pooled types have a column
+    std::uint64_t mCount;
+    std::uint64_t mOwnersOffset;        // EntityID[mCount]
+    std::uint64_t mDataOffset;
+    std::uint64_t mDataSize;
+};
+static_assert(sizeof(MappedColumnEntry) == 64 && "ERROR: mapped column entry layout changed.");
+
+// read-only view of a component column living inside the mapping
+template<typename T>
+struct MappedColumn
+{
+    const EntityID* mOwners{nullptr};
+    const T* mData{nullptr};
+    std::size_t mCount{0u};
+
+    bool empty() const noexcept { return mCount == 0u; }
+    std::size_t size() const noexcept { return mCount; }
+    const T& operator[](std::size_t i) const { return mData[i]; }
+    const T* begin() const noexcept { return mData; }
+    const T* end() const noexcept { return mData + mCount; }
+};
+
+class MappedSnapshot : sf::NonCopyable
+{
+private:
+MappedFile mFile;
+const MappedSnapshotHeader* mHeader{nullptr};
+const MappedColumnEntry* mColumns{nullptr};
+
+bool validate() const;
+
+public:
+// maps the file and checks the header/table bounds, nothing else is touched
+bool open(const std::string& path);
+void close();
+
+bool isOpen() const noexcept { return mHeader != nullptr; }
+
+std::size_t getEntityCount() const noexcept { return mHeader == nullptr ? 0u : static_cast<std::size_t>(mHeader->mEntityCount); }
+const EntityID* getEntityIDs() const noexcept;
+const std::uint32_t* getEntityGroups() const noexcept;
+const std::uint32_t* getEntityTags() const noexcept;
+const std::uint32_t* getEntityDisabled() const noexcept;
+
+const MappedColumnEntry* findColumn(const std::string& name) const noexcept;
+
+// use a trivially copyable column in place (empty view if missing or the layout does not match)
+template<typename T> MappedColumn<T> getColumn(const std::string& name) const
+{
+    static_assert(std::is_trivially_copyable<T>::value && "ERROR: only trivially copyable columns can be used in place.");
+    static_assert(alignof(T) <= mappedSnapshotAlignment && "ERROR: column type is over-aligned.");
+
+    MappedColumn<T> column;
+    auto* entry{findColumn(name)};
+    if(entry == nullptr || entry->mKind != SnapshotPooledType || entry->mRawSize != sizeof(T)) return column;
+
+    column.mOwners = reinterpret_cast<const EntityID*>(mFile.data() + entry->mOwnersOffset);
+    column.mData = reinterpret_cast<const T*>(mFile.data() + entry->mDataOffset);
+    column.mCount = static_cast<std::size_t>(entry->mCount);
+    return column;
+}
+
+// copy the whole snapshot into a manager (clears it first)
+// pooled columns are single memcpys straight out of the mapped pages
+bool loadInto(EntityManager& manager, const SnapshotRegistry& registry) const;
+};
+
+bool saveMappedSnapshot(const EntityManager& manager, const SnapshotRegistry& registry, const std::string& path);
+
+#endif // MAPPEDSNAPSHOT_H
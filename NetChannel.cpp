@@ -0,0 +1,101 @@
+#include "NetChannel.hpp"
+
+#include <iostream>
+#include <algorithm>
+
+NetChannel::NetChannel() : mReceiveBuffer(sf::UdpSocket::MaxDatagramSize)
+{
+    mSocket.setBlocking(false);
+}
+
+bool NetChannel::bind(unsigned short port, const sf::IpAddress& address)
+{
+    if(this->mSocket.bind(port, address) != sf::Socket::Done)
+    {
+        std::cerr << "ERROR: could not bind udp socket to port " << port << "." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void NetChannel::unbind()
+{
+    this->mSocket.unbind();
+    this->mDelayed.clear();
+}
+
+void NetChannel::setConditions(const NetworkConditions& conditions, std::uint32_t seed)
+{
+    this->mConditions = conditions;
+    this->mRandom.seed(seed);
+}
+
+bool NetChannel::sendNow(const char* data, std::size_t size, const sf::IpAddress& address, unsigned short port)
+{
+    // a full send buffer is treated like a lost datagram, the protocol on top copes with that
+    if(this->mSocket.send(data, size, address, port) != sf::Socket::Done) return false;
+    this->mBytesSent += size;
+    ++this->mDatagramsSent;
+    return true;
+}
+
+bool NetChannel::send(const std::vector<char>& data, const sf::IpAddress& address, unsigned short port)
+{
+    if(data.size() > sf::UdpSocket::MaxDatagramSize)
+    {
+        std::cerr << "ERROR: datagram of " << data.size() << " bytes is too large." << std::endl;
+        return false;
+    }
+
+    this->flush();
+
+    std::uniform_real_distribution<float> chance{0.0f, 1.0f};
+    if(this->mConditions.mLoss > 0.0f && chance(this->mRandom) < this->mConditions.mLoss)
+    {
+        ++this->mDatagramsDropped;
+        return true;
+    }
+
+    float delay{this->mConditions.mLatency + this->mConditions.mJitter * chance(this->mRandom)};
+    if(delay <= 0.0f) return this->sendNow(data.data(), data.size(), address, port);
+
+    this->mDelayed.emplace_back(DelayedDatagram{this->mClock.getElapsedTime().asSeconds() + delay, address, port, data});
+    return true;
+}
+
+void NetChannel::flush()
+{
+    if(this->mDelayed.empty()) return;
+
+    float now{this->mClock.getElapsedTime().asSeconds()};
+    auto due{std::stable_partition(this->mDelayed.begin(), this->mDelayed.end(),
+    [now](const DelayedDatagram& datagram)
+    {
+        return datagram.mReleaseTime > now;
+    })};
+
+    // release in order of their due time, jitter is what makes them overtake each other
+    std::stable_sort(due, this->mDelayed.end(),
+    [](const DelayedDatagram& a, const DelayedDatagram& b)
+    {
+        return a.mReleaseTime < b.mReleaseTime;
+    });
+    for(auto it{due}; it != this->mDelayed.end(); ++it)
+    {
+        this->sendNow(it->mData.data(), it->mData.size(), it->mAddress, it->mPort);
+    }
+    this->mDelayed.erase(due, this->mDelayed.end());
+}
+
+bool NetChannel::receive(std::vector<char>& data, sf::IpAddress& sender, unsigned short& port)
+{
+    this->flush();
+
+    std::size_t received{0u};
+    if(this->mSocket.receive(this->mReceiveBuffer.data(), this->mReceiveBuffer.size(), received, sender, port) != sf::Socket::Done)
+    {
+        return false;
+    }
+    data.assign(this->mReceiveBuffer.data(), this->mReceiveBuffer.data() + received);
+    return true;
+}
@@ -0,0 +1,70 @@
+#ifndef NETCHANNEL_H
+#define NETCHANNEL_H
+
+#include <vector>
+#include <random>
+#include <cstdint>
+
+#include <SFML/Network/UdpSocket.hpp>
+#include <SFML/Network/IpAddress.hpp>
+#include <SFML/System/Clock.hpp>
+#include <SFML/System/NonCopyable.hpp>
+
+// == NETWORK CONDITIONS ==
+// applied to outgoing datagrams so replication can be exercised over localhost
+// as if it ran over a real connection (all zero = send straight away)
+struct NetworkConditions
+{
+    float mLoss{0.0f};      // chance [0, 1] that a datagram is dropped
+    float mLatency{0.0f};   // seconds every datagram is held back
+    float mJitter{0.0f};    // up to this many extra seconds per datagram (reorders them)
+};
+
+// non-blocking udp socket that moves raw byte buffers
+class NetChannel : sf::NonCopyable
+{
+private:
+struct DelayedDatagram
+{
+    float mReleaseTime;
+    sf::IpAddress mAddress;
+    unsigned short mPort;
+    std::vector<char> mData;
+};
+
+sf::UdpSocket mSocket;
+NetworkConditions mConditions {};
+std::mt19937 mRandom{};
+sf::Clock mClock;
+std::vector<DelayedDatagram> mDelayed {};
+std::vector<char> mReceiveBuffer {};
+
+std::uint64_t mBytesSent{0u};
+std::uint64_t mDatagramsSent{0u};
+std::uint64_t mDatagramsDropped{0u};
+
+bool sendNow(const char* data, std::size_t size, const sf::IpAddress& address, unsigned short port);
+
+public:
+NetChannel();
+
+// sf::Socket::AnyPort lets the OS pick, see getLocalPort()
+bool bind(unsigned short port, const sf::IpAddress& address = sf::IpAddress::Any);
+void unbind();
+unsigned short getLocalPort() const { return mSocket.getLocalPort(); }
+
+void setConditions(const NetworkConditions& conditions, std::uint32_t seed = 0u);
+const NetworkConditions& getConditions() const noexcept { return mConditions; }
+
+bool send(const std::vector<char>& data, const sf::IpAddress& address, unsigned short port);
+// false if no datagram is waiting
+bool receive(std::vector<char>& data, sf::IpAddress& sender, unsigned short& port);
+// hand delayed datagrams that are due to the socket (send/receive do this as well)
+void flush();
+
+std::uint64_t getBytesSent() const noexcept { return mBytesSent; }
+std::uint64_t getDatagramsSent() const noexcept { return mDatagramsSent; }
+std::uint64_t getDatagramsDropped() const noexcept { return mDatagramsDropped; }
+};
+
+#endif // NETCHANNEL_H
@@ -0,0 +1,63 @@
+#include "RenderBatch.hpp"
+
+#include <cmath>
+
+void QuadRenderer::render(const EntityManager& manager, sf::RenderTarget& target)
+{
+    const auto* pool{manager.getPool(getComponentTypeID<RenderQuad>())};
+    if(pool == nullptr || pool->size() == 0u) return;
+
+    const auto& quads{*static_cast<const ComponentPool<RenderQuad>*>(pool)};
+    const auto* owners{quads.owners()};
+    this->mVertices.resize(quads.size() * 6u);
+
+    std::size_t count{0u};
+    for(std::size_t i{0u}; i < quads.size(); ++i)
+    {
+        auto* entity{manager.getEntity(owners[i])};
+        if(entity == nullptr || !entity->isComponentEnabled<RenderQuad>()) continue;
+
+        const auto& quad{quads.data()[i]};
+        sf::Vector2f right{quad.mSize.x, 0.0f};
+        sf::Vector2f down{0.0f, quad.mSize.y};
+        if(quad.mRotation != 0.0f)
+        {
+            float radians{quad.mRotation * 3.14159265f / 180.0f};
+            float cosine{std::cos(radians)};
+            float sine{std::sin(radians)};
+            right = sf::Vector2f{quad.mSize.x * cosine, quad.mSize.x * sine};
+            down = sf::Vector2f{-quad.mSize.y * sine, quad.mSize.y * cosine};
+        }
+
+        const sf::Vector2f corners[4]{quad.mPosition, quad.mPosition + right, quad.mPosition + right + down, quad.mPosition + down};
+        sf::Vector2f texCoords[4] {};
+        if(this->mAtlas != nullptr)
+        {
+            float left{static_cast<float>(quad.mAtlas[0])};
+            float top{static_cast<float>(quad.mAtlas[1])};
+            float width{static_cast<float>(quad.mAtlas[2])};
+            float height{static_cast<float>(quad.mAtlas[3])};
+            texCoords[0] = sf::Vector2f{left, top};
+            texCoords[1] = sf::Vector2f{left + width, top};
+            texCoords[2] = sf::Vector2f{left + width, top + height};
+            texCoords[3] = sf::Vector2f{left, top + height};
+        }
+
+        // two triangles per quad: 0 1 2, 0 2 3
+        sf::Color color{quad.mColor};
+        sf::Vertex* vertex{&this->mVertices[count * 6u]};
+        for(auto corner : {0u, 1u, 2u, 0u, 2u, 3u})
+        {
+            *vertex++ = sf::Vertex{corners[corner], color, texCoords[corner]};
+        }
+        ++count;
+    }
+
+    // (skipped quads leave unused vertices at the end)
+    this->mVertices.resize(count * 6u);
+    if(count == 0u) return;
+
+    sf::RenderStates states;
+    states.texture = this->mAtlas;
+    target.draw(this->mVertices, states);
+}
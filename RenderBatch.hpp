@@ -0,0 +1,39 @@
+#ifndef RENDERBATCH_H
+#define RENDERBATCH_H
+
+#include "ECS.hpp"
+
+// == RENDER QUAD ==
+// the whole look of a (optionally textured and rotated) rectangle as a pooled 32 byte POD,
+// unlike sf::RectangleShape there is no vertex copy, texture pointer or transform cache per entity
+// it is only ever drawn by QuadRenderer
+struct RenderQuad
+{
+    sf::Vector2f mPosition;                     // top left corner, also the rotation origin (as for sf::Shape)
+    sf::Vector2f mSize;
+    float mRotation{0.0f};                      // degrees, like sf::Transformable
+    sf::Uint32 mColor{0xffffffffu};             // sf::Color::toInteger()
+    sf::Uint16 mAtlas[4]{0u, 0u, 0u, 0u};       // texture rect in the atlas in texels: left, top, width, height
+};
+
+static_assert(sizeof(RenderQuad) <= 32u && "ERROR: RenderQuad grew past 32 bytes.");
+static_assert(std::is_trivially_copyable<RenderQuad>::value && "ERROR: RenderQuad has to stay plain data.");
+
+// == BATCHED QUAD RENDERER ==
+// turns every RenderQuad of a manager into triangles in one vertex array, drawn with a single call
+// (one atlas texture for all quads; the array keeps its capacity between frames)
+// quads whose component is disabled are skipped
+class QuadRenderer
+{
+private:
+sf::VertexArray mVertices{sf::Triangles};
+const sf::Texture* mAtlas{nullptr};
+
+public:
+// nullptr = plain colored quads, atlas rects are ignored
+void setAtlas(const sf::Texture* atlas) noexcept { mAtlas = atlas; }
+
+void render(const EntityManager& manager, sf::RenderTarget& target);
+};
+
+#endif
@@ -0,0 +1,406 @@
+#include "Replay.hpp"
+
+#include <fstream>
+#include <iostream>
+
+constexpr std::uint32_t replayMagic{0x504C4F56u}; // "VOLP"
+constexpr std::uint32_t replayVersion{1u};
+
+// tick flags
+constexpr std::uint8_t tickUpdated{1u << 0};
+constexpr std::uint8_t tickNewDt{1u << 1};
+constexpr std::uint8_t tickHasEvents{1u << 2};
+constexpr std::uint8_t tickHasSpawns{1u << 3};
+
+// == EVENT ENCODING ==
+// only the fields that matter for each event type are stored, integers as varints
+static void writeEvent(BinaryWriter& out, const sf::Event& ev)
+{
+    out.write(static_cast<std::uint8_t>(ev.type));
+
+    switch(ev.type)
+    {
+        case sf::Event::Resized:
+        {
+            out.writeVarint(ev.size.width);
+            out.writeVarint(ev.size.height);
+            break;
+        }
+
+        case sf::Event::TextEntered:
+        {
+            out.writeVarint(ev.text.unicode);
+            break;
+        }
+
+        case sf::Event::KeyPressed:
+        case sf::Event::KeyReleased:
+        {
+            out.writeSignedVarint(ev.key.code);
+            out.write(static_cast<std::uint8_t>(ev.key.alt | ev.key.control << 1 | ev.key.shift << 2 | ev.key.system << 3));
+            break;
+        }
+
+        case sf::Event::MouseWheelMoved:
+        {
+            out.writeSignedVarint(ev.mouseWheel.delta);
+            out.writeSignedVarint(ev.mouseWheel.x);
+            out.writeSignedVarint(ev.mouseWheel.y);
+            break;
+        }
+
+        case sf::Event::MouseWheelScrolled:
+        {
+            out.write(static_cast<std::uint8_t>(ev.mouseWheelScroll.wheel));
+            out.write(ev.mouseWheelScroll.delta);
+            out.writeSignedVarint(ev.mouseWheelScroll.x);
+            out.writeSignedVarint(ev.mouseWheelScroll.y);
+            break;
+        }
+
+        case sf::Event::MouseButtonPressed:
+        case sf::Event::MouseButtonReleased:
+        {
+            out.write(static_cast<std::uint8_t>(ev.mouseButton.button));
+            out.writeSignedVarint(ev.mouseButton.x);
+            out.writeSignedVarint(ev.mouseButton.y);
+            break;
+        }
+
+        case sf::Event::MouseMoved:
+        {
+            out.writeSignedVarint(ev.mouseMove.x);
+            out.writeSignedVarint(ev.mouseMove.y);
+            break;
+        }
+
+        case sf::Event::JoystickButtonPressed:
+        case sf::Event::JoystickButtonReleased:
+        {
+            out.writeVarint(ev.joystickButton.joystickId);
+            out.writeVarint(ev.joystickButton.button);
+            break;
+        }
+
+        case sf::Event::JoystickMoved:
+        {
+            out.writeVarint(ev.joystickMove.joystickId);
+            out.write(static_cast<std::uint8_t>(ev.joystickMove.axis));
+            out.write(ev.joystickMove.position);
+            break;
+        }
+
+        case sf::Event::JoystickConnected:
+        case sf::Event::JoystickDisconnected:
+        {
+            out.writeVarint(ev.joystickConnect.joystickId);
+            break;
+        }
+
+        case sf::Event::TouchBegan:
+        case sf::Event::TouchMoved:
+        case sf::Event::TouchEnded:
+        {
+            out.writeVarint(ev.touch.finger);
+            out.writeSignedVarint(ev.touch.x);
+            out.writeSignedVarint(ev.touch.y);
+            break;
+        }
+
+        case sf::Event::SensorChanged:
+        {
+            out.write(static_cast<std::uint8_t>(ev.sensor.type));
+            out.write(ev.sensor.x);
+            out.write(ev.sensor.y);
+            out.write(ev.sensor.z);
+            break;
+        }
+
+        // no data
+        default:
+        {
+            break;
+        }
+    }
+}
+
+static bool readEvent(BinaryReader& in, sf::Event& ev)
+{
+    auto type{in.read<std::uint8_t>()};
+    if(type >= sf::Event::Count) return false;
+
+    ev = sf::Event{};
+    ev.type = static_cast<sf::Event::EventType>(type);
+
+    switch(ev.type)
+    {
+        case sf::Event::Resized:
+        {
+            ev.size.width = static_cast<unsigned int>(in.readVarint());
+            ev.size.height = static_cast<unsigned int>(in.readVarint());
+            break;
+        }
+
+        case sf::Event::TextEntered:
+        {
+            ev.text.unicode = static_cast<sf::Uint32>(in.readVarint());
+            break;
+        }
+
+        case sf::Event::KeyPressed:
+        case sf::Event::KeyReleased:
+        {
+            ev.key.code = static_cast<sf::Keyboard::Key>(in.readSignedVarint());
+            auto modifiers{in.read<std::uint8_t>()};
+            ev.key.alt = (modifiers & 1u) != 0u;
+            ev.key.control = (modifiers & 2u) != 0u;
+            ev.key.shift = (modifiers & 4u) != 0u;
+            ev.key.system = (modifiers & 8u) != 0u;
+            break;
+        }
+
+        case sf::Event::MouseWheelMoved:
+        {
+            ev.mouseWheel.delta = static_cast<int>(in.readSignedVarint());
+            ev.mouseWheel.x = static_cast<int>(in.readSignedVarint());
+            ev.mouseWheel.y = static_cast<int>(in.readSignedVarint());
+            break;
+        }
+
+        case sf::Event::MouseWheelScrolled:
+        {
+            ev.mouseWheelScroll.wheel = static_cast<sf::Mouse::Wheel>(in.read<std::uint8_t>());
+            ev.mouseWheelScroll.delta = in.read<float>();
+            ev.mouseWheelScroll.x = static_cast<int>(in.readSignedVarint());
+            ev.mouseWheelScroll.y = static_cast<int>(in.readSignedVarint());
+            break;
+        }
+
+        case sf::Event::MouseButtonPressed:
+        case sf::Event::MouseButtonReleased:
+        {
+            ev.mouseButton.button = static_cast<sf::Mouse::Button>(in.read<std::uint8_t>());
+            ev.mouseButton.x = static_cast<int>(in.readSignedVarint());
+            ev.mouseButton.y = static_cast<int>(in.readSignedVarint());
+            break;
+        }
+
+        case sf::Event::MouseMoved:
+        {
+            ev.mouseMove.x = static_cast<int>(in.readSignedVarint());
+            ev.mouseMove.y = static_cast<int>(in.readSignedVarint());
+            break;
+        }
+
+        case sf::Event::JoystickButtonPressed:
+        case sf::Event::JoystickButtonReleased:
+        {
+            ev.joystickButton.joystickId = static_cast<unsigned int>(in.readVarint());
+            ev.joystickButton.button = static_cast<unsigned int>(in.readVarint());
+            break;
+        }
+
+        case sf::Event::JoystickMoved:
+        {
+            ev.joystickMove.joystickId = static_cast<unsigned int>(in.readVarint());
+            ev.joystickMove.axis = static_cast<sf::Joystick::Axis>(in.read<std::uint8_t>());
+            ev.joystickMove.position = in.read<float>();
+            break;
+        }
+
+        case sf::Event::JoystickConnected:
+        case sf::Event::JoystickDisconnected:
+        {
+            ev.joystickConnect.joystickId = static_cast<unsigned int>(in.readVarint());
+            break;
+        }
+
+        case sf::Event::TouchBegan:
+        case sf::Event::TouchMoved:
+        case sf::Event::TouchEnded:
+        {
+            ev.touch.finger = static_cast<unsigned int>(in.readVarint());
+            ev.touch.x = static_cast<int>(in.readSignedVarint());
+            ev.touch.y = static_cast<int>(in.readSignedVarint());
+            break;
+        }
+
+        case sf::Event::SensorChanged:
+        {
+            ev.sensor.type = static_cast<sf::Sensor::Type>(in.read<std::uint8_t>());
+            ev.sensor.x = in.read<float>();
+            ev.sensor.y = in.read<float>();
+            ev.sensor.z = in.read<float>();
+            break;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+    return !in.failed();
+}
+
+// == RECORDER ==
+void ReplayRecorder::start(std::uint32_t seed)
+{
+    this->mTicks.clear();
+    this->mSeed = seed;
+    this->mTickCount = 0u;
+    this->mLastDt = 0.0f;
+    this->mCurrent.clear();
+    this->mRecording = true;
+}
+
+void ReplayRecorder::recordEvent(const sf::Event& ev)
+{
+    if(this->mRecording) this->mCurrent.mEvents.emplace_back(ev);
+}
+
+void ReplayRecorder::recordSpawn(std::uint16_t kind, std::uint32_t count)
+{
+    if(this->mRecording) this->mCurrent.mSpawns.emplace_back(ReplaySpawn{kind, count});
+}
+
+void ReplayRecorder::endTick(bool updated, float dt)
+{
+    if(!this->mRecording) return;
+
+    // most ticks are "stepped, same dt as last time, nothing happened" -> a single byte
+    BinaryWriter out{this->mTicks};
+    std::uint8_t flags{0u};
+    bool newDt{updated && dt != this->mLastDt};
+    if(updated) flags |= tickUpdated;
+    if(newDt) flags |= tickNewDt;
+    if(!this->mCurrent.mEvents.empty()) flags |= tickHasEvents;
+    if(!this->mCurrent.mSpawns.empty()) flags |= tickHasSpawns;
+    out.write(flags);
+
+    if(newDt)
+    {
+        out.write(dt);
+        this->mLastDt = dt;
+    }
+
+    if(!this->mCurrent.mEvents.empty())
+    {
+        out.writeVarint(this->mCurrent.mEvents.size());
+        for(auto& ev : this->mCurrent.mEvents) writeEvent(out, ev);
+    }
+
+    if(!this->mCurrent.mSpawns.empty())
+    {
+        out.writeVarint(this->mCurrent.mSpawns.size());
+        for(auto& spawn : this->mCurrent.mSpawns)
+        {
+            out.writeVarint(spawn.mKind);
+            out.writeVarint(spawn.mCount);
+        }
+    }
+
+    ++this->mTickCount;
+    this->mCurrent.clear();
+}
+
+void ReplayRecorder::save(std::vector<char>& buffer) const
+{
+    buffer.clear();
+    BinaryWriter out{buffer};
+    out.write(replayMagic);
+    out.write(replayVersion);
+    out.write(this->mSeed);
+    out.write(this->mTickCount);
+    out.writeBytes(this->mTicks.data(), this->mTicks.size());
+}
+
+bool ReplayRecorder::saveToFile(const std::string& path) const
+{
+    std::vector<char> buffer;
+    this->save(buffer);
+
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    return static_cast<bool>(file);
+}
+
+// == PLAYER ==
+bool ReplayPlayer::load(const char* data, std::size_t size)
+{
+    this->mData.assign(data, data + size);
+    this->mReader = BinaryReader{this->mData.data(), this->mData.size()};
+
+    if(this->mReader.read<std::uint32_t>() != replayMagic || this->mReader.read<std::uint32_t>() != replayVersion)
+    {
+        std::cerr << "ERROR: not a replay, or recorded by an incompatible version." << std::endl;
+        this->mData.clear();
+        this->mReader = BinaryReader{nullptr, 0u};
+        return false;
+    }
+
+    this->mSeed = this->mReader.read<std::uint32_t>();
+    this->mTickCount = this->mReader.read<std::uint32_t>();
+    this->mTicksRead = 0u;
+    this->mLastDt = 0.0f;
+    return !this->mReader.failed();
+}
+
+bool ReplayPlayer::loadFromFile(const std::string& path)
+{
+    std::ifstream file{path, std::ios::binary | std::ios::ate};
+    if(!file)
+    {
+        std::cerr << "ERROR: could not open replay '" << path << "'." << std::endl;
+        return false;
+    }
+
+    std::vector<char> buffer(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    return file && this->load(buffer.data(), buffer.size());
+}
+
+bool ReplayPlayer::nextTick(ReplayTick& tick)
+{
+    tick.clear();
+    if(this->mTicksRead >= this->mTickCount || this->mReader.failed()) return false;
+
+    auto& in{this->mReader};
+    auto flags{in.read<std::uint8_t>()};
+    if((flags & tickNewDt) != 0u) this->mLastDt = in.read<float>();
+    tick.mUpdated = (flags & tickUpdated) != 0u;
+    tick.mDt = tick.mUpdated ? this->mLastDt : 0.0f;
+
+    if((flags & tickHasEvents) != 0u)
+    {
+        auto count{in.readVarint()};
+        if(count > in.remaining()) in.setFailed();
+        for(std::uint64_t i{0u}; i < count && !in.failed(); ++i)
+        {
+            sf::Event ev;
+            if(!readEvent(in, ev)) in.setFailed();
+            else tick.mEvents.emplace_back(ev);
+        }
+    }
+
+    if((flags & tickHasSpawns) != 0u)
+    {
+        auto count{in.readVarint()};
+        if(count > in.remaining()) in.setFailed();
+        for(std::uint64_t i{0u}; i < count && !in.failed(); ++i)
+        {
+            auto kind{in.readVarint()};
+            auto spawnCount{in.readVarint()};
+            if(kind > 0xFFFFu || spawnCount > 0xFFFFFFFFu) in.setFailed();
+            else tick.mSpawns.emplace_back(ReplaySpawn{static_cast<std::uint16_t>(kind), static_cast<std::uint32_t>(spawnCount)});
+        }
+    }
+
+    if(in.failed())
+    {
+        std::cerr << "ERROR: replay is truncated or corrupt after tick " << this->mTicksRead << "." << std::endl;
+        return false;
+    }
+    ++this->mTicksRead;
+    return true;
+}
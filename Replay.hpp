@@ -0,0 +1,84 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "BinaryStream.hpp"
+
+#include <SFML/Window/Event.hpp>
+
+// == REPLAYS ==
+// a replay is the RNG seed of a session plus, for every tick (one pass of the game loop),
+// the window events polled, the spawn commands issued and the dt the world was updated with
+// re-running those ticks on a fresh world reproduces the session, without a window and as fast as possible
+
+// request to create 'mCount' entities of a game defined kind
+struct ReplaySpawn
+{
+    std::uint16_t mKind;
+    std::uint32_t mCount;
+};
+
+struct ReplayTick
+{
+    bool mUpdated{false};   // false if the world was not stepped this tick
+    float mDt{0.0f};
+    std::vector<sf::Event> mEvents {};
+    std::vector<ReplaySpawn> mSpawns {};
+
+    void clear()
+    {
+        mUpdated = false;
+        mDt = 0.0f;
+        mEvents.clear();
+        mSpawns.clear();
+    }
+};
+
+class ReplayRecorder
+{
+private:
+std::vector<char> mTicks {};
+std::uint32_t mSeed{0u};
+std::uint32_t mTickCount{0u};
+float mLastDt{0.0f};
+bool mRecording{false};
+ReplayTick mCurrent {};
+
+public:
+void start(std::uint32_t seed);
+void stop() { mRecording = false; }
+bool isRecording() const noexcept { return mRecording; }
+
+// collect into the current tick
+void recordEvent(const sf::Event& ev);
+void recordSpawn(std::uint16_t kind, std::uint32_t count);
+// close the current tick (dt is only relevant if the world was updated)
+void endTick(bool updated, float dt);
+
+std::uint32_t getTickCount() const noexcept { return mTickCount; }
+
+void save(std::vector<char>& buffer) const;
+bool saveToFile(const std::string& path) const;
+};
+
+class ReplayPlayer
+{
+private:
+std::vector<char> mData {};
+BinaryReader mReader{nullptr, 0u};
+std::uint32_t mSeed{0u};
+std::uint32_t mTickCount{0u};
+std::uint32_t mTicksRead{0u};
+float mLastDt{0.0f};
+
+public:
+bool load(const char* data, std::size_t size);
+bool loadFromFile(const std::string& path);
+
+std::uint32_t getSeed() const noexcept { return mSeed; }
+std::uint32_t getTickCount() const noexcept { return mTickCount; }
+
+// decode the next tick, false once the replay is exhausted (or corrupt)
+bool nextTick(ReplayTick& tick);
+};
+
+#endif // REPLAY_H
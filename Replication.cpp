@@ -0,0 +1,644 @@
+#include "Replication.hpp"
+
+#include <iostream>
+
+// kind, sequence, baseline sequence, server tick
+constexpr std::size_t replicationHeaderSize{1u + 3u * sizeof(std::uint32_t)};
+// worst case overhead of one entity in an update (id delta varint + component mask + removed mask)
+constexpr std::size_t replicationEntityOverhead{15u};
+
+static const ReplicationState emptyReplicationState {};
+
+// == REGISTRY ==
+std::size_t ReplicationRegistry::stateSize(std::uint32_t mask) const noexcept
+{
+    std::size_t size{0u};
+    for(std::size_t t{0u}; t < mEntries.size(); ++t)
+    {
+        if((mask & (1u << t)) != 0u) size += mEntries[t].mSize;
+    }
+    return size;
+}
+
+std::size_t ReplicationRegistry::componentOffset(std::uint32_t mask, std::size_t type) const noexcept
+{
+    std::size_t offset{0u};
+    for(std::size_t t{0u}; t < type; ++t)
+    {
+        if((mask & (1u << t)) != 0u) offset += mEntries[t].mSize;
+    }
+    return offset;
+}
+
+// == STATE ==
+const ReplicationState::EntityState* ReplicationState::find(EntityID id) const noexcept
+{
+    auto it{std::lower_bound(mEntities.begin(), mEntities.end(), id,
+    [](const EntityState& entity, EntityID value)
+    {
+        return entity.mID < value;
+    })};
+    return (it == mEntities.end() || it->mID != id) ? nullptr : &*it;
+}
+
+static void appendEntity(ReplicationState& out, EntityID id, std::uint32_t mask, const char* bytes, std::size_t size)
+{
+    auto offset{out.mBytes.size()};
+    out.mEntities.emplace_back(ReplicationState::EntityState{id, mask, static_cast<std::uint32_t>(offset)});
+    out.mBytes.resize(offset + size);
+    if(size != 0u) std::memcpy(out.mBytes.data() + offset, bytes, size);
+}
+
+void applyReplicationDelta(const ReplicationRegistry& registry, const ReplicationState& baseline,
+    const ReplicationDelta& delta, ReplicationState& out)
+{
+    out.clear();
+    auto& entries{registry.getEntries()};
+    auto& changes{delta.mChanges.mEntities};
+    std::size_t d{0u};
+    std::size_t c{0u};
+
+    auto appendChange = [&](const ReplicationState::EntityState& change)
+    {
+        appendEntity(out, change.mID, change.mMask, delta.mChanges.mBytes.data() + change.mOffset, registry.stateSize(change.mMask));
+    };
+
+    for(auto& base : baseline.mEntities)
+    {
+        // entities the baseline did not have yet (nothing to remove from them)
+        while(c < changes.size() && changes[c].mID < base.mID) appendChange(changes[c++]);
+
+        while(d < delta.mDespawns.size() && delta.mDespawns[d] < base.mID) ++d;
+        if(d < delta.mDespawns.size() && delta.mDespawns[d] == base.mID) continue;
+
+        const char* baseBytes{baseline.mBytes.data() + base.mOffset};
+        if(c == changes.size() || changes[c].mID != base.mID)
+        {
+            appendEntity(out, base.mID, base.mMask, baseBytes, registry.stateSize(base.mMask));
+            continue;
+        }
+
+        // merge: changed components from the delta, the rest from the baseline minus the removed ones
+        auto removed{delta.mRemoved[c]};
+        auto& change{changes[c++]};
+        const char* changeBytes{delta.mChanges.mBytes.data() + change.mOffset};
+        std::uint32_t mask{(base.mMask & ~removed) | change.mMask};
+        auto offset{out.mBytes.size()};
+        out.mEntities.emplace_back(ReplicationState::EntityState{base.mID, mask, static_cast<std::uint32_t>(offset)});
+        out.mBytes.resize(offset + registry.stateSize(mask));
+
+        char* dst{out.mBytes.data() + offset};
+        for(std::size_t t{0u}; t < entries.size(); ++t)
+        {
+            std::uint32_t bit{1u << t};
+            auto size{entries[t].mSize};
+            if((mask & bit) != 0u)
+            {
+                std::memcpy(dst, (change.mMask & bit) != 0u ? changeBytes : baseBytes, size);
+                dst += size;
+            }
+            if((change.mMask & bit) != 0u) changeBytes += size;
+            if((base.mMask & bit) != 0u) baseBytes += size;
+        }
+    }
+
+    while(c < changes.size()) appendChange(changes[c++]);
+}
+
+// == SERVER ==
+std::size_t ReplicationServer::addClient(std::uint32_t bytesPerSecond)
+{
+    std::size_t slot{0u};
+    while(slot < this->mClients.size() && this->mClients[slot].mActive) ++slot;
+    if(slot == this->mClients.size()) this->mClients.emplace_back();
+
+    auto& client{this->mClients[slot]};
+    client = ClientState{};
+    client.mActive = true;
+    client.mBytesPerSecond = bytesPerSecond;
+    client.mFrames.resize(replicationHistory);
+    return slot;
+}
+
+void ReplicationServer::removeClient(std::size_t client)
+{
+    assert(client < this->mClients.size() && "ERROR: unknown replication client.");
+    this->mClients[client] = ClientState{};
+}
+
+void ReplicationServer::setBandwidth(std::size_t client, std::uint32_t bytesPerSecond)
+{
+    assert(client < this->mClients.size() && this->mClients[client].mActive && "ERROR: unknown replication client.");
+    this->mClients[client].mBytesPerSecond = bytesPerSecond;
+}
+
+void ReplicationServer::captureState()
+{
+    ++this->mTick;
+    auto& state{this->mCurrent};
+    state.clear();
+
+    auto& entries{this->mRegistry.getEntries()};
+    for(std::size_t t{0u}; t < entries.size(); ++t) this->mEncodedBits[t] = entries[t].encode == nullptr ? entries[t].mSize * 8u : 0u;
+
+    std::array<const BaseComponentPool*, maxReplicatedTypes> pools {};
+    std::vector<EntityID> ids;
+    for(std::size_t t{0u}; t < entries.size(); ++t)
+    {
+        if(entries[t].mTag) continue;
+        pools[t] = this->mManager.getPool(entries[t].mTypeID);
+        if(pools[t] != nullptr) ids.insert(ids.end(), pools[t]->owners(), pools[t]->owners() + pools[t]->size());
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+    state.mEntities.reserve(ids.size());
+    for(auto id : ids)
+    {
+        std::uint32_t mask{0u};
+        const Entity* entity{nullptr};
+        for(std::size_t t{0u}; t < entries.size(); ++t)
+        {
+            if(entries[t].mTag)
+            {
+                if(entity == nullptr) entity = this->mManager.getEntity(id);
+                if(entity != nullptr && entity->getSignature()[entries[t].mTypeID]) mask |= 1u << t;
+            }
+            else if(pools[t] != nullptr && pools[t]->contains(id)) mask |= 1u << t;
+        }
+
+        auto offset{state.mBytes.size()};
+        state.mEntities.emplace_back(ReplicationState::EntityState{id, mask, static_cast<std::uint32_t>(offset)});
+        state.mBytes.resize(offset + this->mRegistry.stateSize(mask));
+
+        char* dst{state.mBytes.data() + offset};
+        for(std::size_t t{0u}; t < entries.size(); ++t)
+        {
+            if((mask & (1u << t)) == 0u || entries[t].mTag) continue;
+
+            auto& entry{entries[t]};
+            const void* value{entry.read(*pools[t], id)};
+            if(entry.encode == nullptr)
+            {
+                std::memcpy(dst, value, entry.mSize);
+            }
+            else
+            {
+                // keep what the client will decode, not the exact value, so changes below
+                // the quantization step are not detected (and resent) every tick
+                this->mQuantizeScratch.clear();
+                BitWriter bits{this->mQuantizeScratch};
+                entry.encode(bits, static_cast<const char*>(value));
+                bits.flush();
+                this->mEncodedBits[t] = std::max(this->mEncodedBits[t], bits.bitCount());
+
+                BitReader in{this->mQuantizeScratch.data(), this->mQuantizeScratch.size()};
+                entry.decode(in, dst);
+            }
+            dst += entry.mSize;
+        }
+    }
+}
+
+const ReplicationState* ReplicationServer::getBaseline(const ClientState& client) const noexcept
+{
+    if(client.mAcked == 0u) return nullptr;
+    auto& frame{client.mFrames[client.mAcked % replicationHistory]};
+    return frame.mSequence == client.mAcked ? &frame.mState : nullptr;
+}
+
+void ReplicationServer::setViewer(std::size_t client, sf::Vector2f position, float radius, float hysteresis)
+{
+    assert(client < this->mClients.size() && this->mClients[client].mActive && "ERROR: unknown replication client.");
+    auto& state{this->mClients[client]};
+    state.mViewPosition = position;
+    state.mViewRadius = radius;
+    state.mViewHysteresis = hysteresis;
+}
+
+float& ReplicationServer::getPriority(ClientState& client, EntityID id)
+{
+    auto index{getEntityIndex(id)};
+    if(index >= client.mPriorities.size()) client.mPriorities.resize(index + 1u);
+
+    // the slot may still hold what a destroyed entity had accumulated
+    auto& entry{client.mPriorities[index]};
+    if(entry.mID != id) entry = PriorityEntry{id, 0.0f};
+    return entry.mValue;
+}
+
+void ReplicationServer::gatherRelevant(const ClientState& client)
+{
+    auto& relevant{this->mRelevant};
+    relevant.clear();
+
+    if(this->mInterestGrid == nullptr)
+    {
+        for(std::uint32_t i{0u}; i < this->mCurrent.mEntities.size(); ++i) relevant.emplace_back(Relevant{i, 1.0f});
+        return;
+    }
+
+    // what the client holds after the last update, those get the hysteresis margin
+    auto& shown{client.mFrames[client.mSequence % replicationHistory]};
+    bool hasShown{client.mSequence != 0u && shown.mSequence == client.mSequence};
+
+    float enterSquared{client.mViewRadius * client.mViewRadius};
+    float leaveRadius{client.mViewRadius + client.mViewHysteresis};
+    auto* begin{this->mCurrent.mEntities.data()};
+    this->mInterestGrid->query(client.mViewPosition, leaveRadius,
+    [&](EntityID id, float distanceSquared)
+    {
+        if(distanceSquared > enterSquared && !(hasShown && shown.mState.find(id) != nullptr)) return;
+
+        auto* entity{this->mCurrent.find(id)};
+        if(entity == nullptr) return;
+
+        // nearer entities accumulate priority faster
+        float relevance{leaveRadius > 0.0f ? 1.0f - std::sqrt(distanceSquared) / leaveRadius : 1.0f};
+        relevant.emplace_back(Relevant{static_cast<std::uint32_t>(entity - begin), std::max(relevance, 0.1f)});
+    });
+
+    std::sort(relevant.begin(), relevant.end(),
+    [](const Relevant& a, const Relevant& b)
+    {
+        return a.mEntity < b.mEntity;
+    });
+}
+
+bool ReplicationServer::writeUpdate(std::size_t clientIndex, float dt, std::vector<char>& packet)
+{
+    assert(clientIndex < this->mClients.size() && this->mClients[clientIndex].mActive && "ERROR: unknown replication client.");
+    auto& client{this->mClients[clientIndex]};
+    auto& entries{this->mRegistry.getEntries()};
+
+    // credit accrues with time, at most one second worth of it can be banked
+    auto rate{static_cast<float>(client.mBytesPerSecond)};
+    client.mCredit = std::min(client.mCredit + rate * dt, rate);
+    if(client.mCredit < static_cast<float>(replicationHeaderSize)) return false;
+    auto budget{std::min(replicationMaxDatagram, static_cast<std::size_t>(client.mCredit))};
+
+    // an unknown (or too old) ack means the client gets everything from scratch
+    auto* known{this->getBaseline(client)};
+    auto& baseline{known != nullptr ? *known : emptyReplicationState};
+
+    // == diff the relevant entities against the baseline ==
+    // baseline entities that are gone or out of view are despawned on the client
+    this->gatherRelevant(client);
+    this->mDelta.clear();
+    this->mCandidates.clear();
+    auto& current{this->mCurrent.mEntities};
+    std::size_t b{0u};
+    for(auto& relevant : this->mRelevant)
+    {
+        auto& entity{current[relevant.mEntity]};
+        while(b < baseline.mEntities.size() && baseline.mEntities[b].mID < entity.mID)
+        {
+            this->mDelta.mDespawns.emplace_back(baseline.mEntities[b++].mID);
+        }
+
+        const ReplicationState::EntityState* previous{nullptr};
+        if(b < baseline.mEntities.size() && baseline.mEntities[b].mID == entity.mID) previous = &baseline.mEntities[b++];
+
+        Candidate candidate{relevant.mEntity, 0u, previous != nullptr ? previous->mMask & ~entity.mMask : 0u, 0.0f, 0u};
+        std::uint32_t priority{0u};
+        const char* bytes{this->mCurrent.mBytes.data() + entity.mOffset};
+        for(std::size_t t{0u}; t < entries.size(); ++t)
+        {
+            std::uint32_t bit{1u << t};
+            if((entity.mMask & bit) == 0u) continue;
+
+            auto& entry{entries[t]};
+            const char* value{bytes};
+            bytes += entry.mSize;
+
+            // components the client already has are only resent when they changed (and their interval is due)
+            if(previous != nullptr && (previous->mMask & bit) != 0u)
+            {
+                if(this->mTick % entry.mRule.mInterval != 0u) continue;
+                const char* old{baseline.mBytes.data() + previous->mOffset + this->mRegistry.componentOffset(previous->mMask, t)};
+                if(std::memcmp(value, old, entry.mSize) == 0) continue;
+            }
+
+            candidate.mMask |= bit;
+            priority = std::max<std::uint32_t>(priority, entry.mRule.mPriority);
+            candidate.mSize += this->mEncodedBits[t];
+        }
+        if(candidate.mMask == 0u && candidate.mRemoved == 0u) continue;
+
+        candidate.mSize = replicationEntityOverhead + (candidate.mSize + 7u) / 8u;
+        candidate.mPriority = this->getPriority(client, entity.mID) + static_cast<float>(priority) * relevant.mRelevance;
+        this->mCandidates.emplace_back(candidate);
+    }
+    while(b < baseline.mEntities.size()) this->mDelta.mDespawns.emplace_back(baseline.mEntities[b++].mID);
+
+    // == fit the budget ==
+    // despawns go first, changes by accumulated priority (stable, so id order breaks ties)
+    // whatever does not fit is left out of the delta, so the client state recorded for this update still
+    // has it: despawns are sent again by a later update, changes keep their priority and win a later one
+    // the first entry of an update always goes, so a small budget can not starve anything, and a change
+    // bigger than a whole datagram is cut down to the components that fit (the rest stay changed)
+    std::size_t used{replicationHeaderSize + 2u * 5u};
+    auto& despawns{this->mDelta.mDespawns};
+    if(!despawns.empty())
+    {
+        auto fitting{std::max<std::size_t>(1u, budget > used ? (budget - used) / 5u : 0u)};
+        if(despawns.size() > fitting) despawns.resize(fitting);
+        used += despawns.size() * 5u;
+    }
+
+    std::stable_sort(this->mCandidates.begin(), this->mCandidates.end(),
+    [](const Candidate& a, const Candidate& b)
+    {
+        return a.mPriority > b.mPriority;
+    });
+
+    std::size_t selected{0u};
+    for(auto& candidate : this->mCandidates)
+    {
+        auto& priority{this->getPriority(client, current[candidate.mEntity].mID)};
+        bool first{selected == 0u && despawns.empty()};
+        if(used + candidate.mSize > budget && !first)
+        {
+            priority = candidate.mPriority;
+            continue;
+        }
+
+        priority = 0.0f;
+        if(used + candidate.mSize > replicationMaxDatagram)
+        {
+            std::uint32_t mask{0u};
+            std::size_t bitCount{0u};
+            for(std::size_t t{0u}; t < entries.size(); ++t)
+            {
+                std::uint32_t bit{1u << t};
+                if((candidate.mMask & bit) == 0u) continue;
+                if(used + replicationEntityOverhead + (bitCount + this->mEncodedBits[t] + 7u) / 8u > replicationMaxDatagram) continue;
+                mask |= bit;
+                bitCount += this->mEncodedBits[t];
+            }
+            candidate.mMask = mask;
+            candidate.mSize = replicationEntityOverhead + (bitCount + 7u) / 8u;
+            priority = candidate.mPriority;
+        }
+        used += candidate.mSize;
+        this->mCandidates[selected++] = candidate;
+    }
+    this->mCandidates.resize(selected);
+    std::sort(this->mCandidates.begin(), this->mCandidates.end(),
+    [](const Candidate& a, const Candidate& b)
+    {
+        return a.mEntity < b.mEntity;
+    });
+
+    auto& changes{this->mDelta.mChanges};
+    for(auto& candidate : this->mCandidates)
+    {
+        auto& entity{current[candidate.mEntity]};
+        auto offset{changes.mBytes.size()};
+        changes.mEntities.emplace_back(ReplicationState::EntityState{entity.mID, candidate.mMask, static_cast<std::uint32_t>(offset)});
+        changes.mBytes.resize(offset + this->mRegistry.stateSize(candidate.mMask));
+        this->mDelta.mRemoved.emplace_back(candidate.mRemoved);
+
+        char* dst{changes.mBytes.data() + offset};
+        const char* src{this->mCurrent.mBytes.data() + entity.mOffset};
+        for(std::size_t t{0u}; t < entries.size(); ++t)
+        {
+            std::uint32_t bit{1u << t};
+            if((entity.mMask & bit) == 0u) continue;
+            if((candidate.mMask & bit) != 0u)
+            {
+                std::memcpy(dst, src, entries[t].mSize);
+                dst += entries[t].mSize;
+            }
+            src += entries[t].mSize;
+        }
+    }
+
+    // == encode ==
+    ++client.mSequence;
+    packet.clear();
+    BinaryWriter out{packet};
+    out.write(replicationUpdatePacket);
+    out.write(client.mSequence);
+    out.write(known != nullptr ? client.mAcked : 0u);
+    out.write(this->mTick);
+
+    // the body is bit packed: ids are sorted, so they are sent as varint differences to the previous one,
+    // component masks take one bit per replicated type (the removed mask only follows a set flag bit),
+    // components go through their quantizer if they have one
+    BitWriter bits{packet};
+    EntityID last{0u};
+    bits.writeVarint(this->mDelta.mDespawns.size());
+    for(auto id : this->mDelta.mDespawns)
+    {
+        bits.writeVarint(id - last);
+        last = id;
+    }
+
+    last = 0u;
+    bits.writeVarint(changes.mEntities.size());
+    for(std::size_t i{0u}; i < changes.mEntities.size(); ++i)
+    {
+        auto& change{changes.mEntities[i]};
+        auto removed{this->mDelta.mRemoved[i]};
+        bits.writeVarint(change.mID - last);
+        bits.writeBits(change.mMask, static_cast<unsigned>(entries.size()));
+        bits.writeBool(removed != 0u);
+        if(removed != 0u) bits.writeBits(removed, static_cast<unsigned>(entries.size()));
+        last = change.mID;
+
+        const char* src{changes.mBytes.data() + change.mOffset};
+        for(std::size_t t{0u}; t < entries.size(); ++t)
+        {
+            if((change.mMask & (1u << t)) == 0u) continue;
+            if(entries[t].encode != nullptr) entries[t].encode(bits, src);
+            else bits.writeBytes(src, entries[t].mSize);
+            src += entries[t].mSize;
+        }
+    }
+    bits.flush();
+
+    // remember what the client will hold once this arrives, it becomes the baseline when acked
+    // (built aside first, the slot being replaced may be the baseline itself)
+    ClientFrame frame;
+    frame.mSequence = client.mSequence;
+    applyReplicationDelta(this->mRegistry, baseline, this->mDelta, frame.mState);
+    client.mFrames[client.mSequence % replicationHistory] = std::move(frame);
+
+    client.mCredit -= static_cast<float>(packet.size());
+    return true;
+}
+
+bool ReplicationServer::readAck(std::size_t clientIndex, const char* data, std::size_t size)
+{
+    assert(clientIndex < this->mClients.size() && "ERROR: unknown replication client.");
+    auto& client{this->mClients[clientIndex]};
+
+    BinaryReader in{data, size};
+    auto kind{in.read<std::uint8_t>()};
+    auto sequence{in.read<std::uint32_t>()};
+    if(in.failed() || kind != replicationAckPacket) return false;
+
+    // acks may arrive out of order, only ever move forward
+    if(client.mActive && sequence > client.mAcked && sequence <= client.mSequence) client.mAcked = sequence;
+    return true;
+}
+
+// == CLIENT ==
+bool ReplicationClient::readUpdate(const char* data, std::size_t size)
+{
+    BinaryReader in{data, size};
+    auto kind{in.read<std::uint8_t>()};
+    auto sequence{in.read<std::uint32_t>()};
+    auto baselineSequence{in.read<std::uint32_t>()};
+    auto tick{in.read<std::uint32_t>()};
+    if(in.failed() || kind != replicationUpdatePacket) return false;
+
+    // late or duplicated datagram, a newer state is already shown
+    if(sequence <= this->mLatest) return true;
+
+    const ReplicationState* baseline{&emptyReplicationState};
+    if(baselineSequence != 0u)
+    {
+        auto& frame{this->mFrames[baselineSequence % replicationHistory]};
+        if(frame.mSequence != baselineSequence) return false;
+        baseline = &frame.mState;
+    }
+
+    // == decode ==
+    auto& entries{this->mRegistry.getEntries()};
+    auto& delta{this->mDelta};
+    delta.clear();
+    BitReader bits{data + in.offset(), in.remaining()};
+
+    auto count{bits.readVarint()};
+    if(count > bits.remainingBits()) bits.setFailed();
+    std::uint64_t id{0u};
+    for(std::uint64_t i{0u}; i < count && !bits.failed(); ++i)
+    {
+        auto step{bits.readVarint()};
+        if(i != 0u && step == 0u) bits.setFailed();
+        id += step;
+        if(id > ~EntityID{0}) bits.setFailed();
+        delta.mDespawns.emplace_back(static_cast<EntityID>(id));
+    }
+
+    count = bits.readVarint();
+    if(count > bits.remainingBits()) bits.setFailed();
+    id = 0u;
+    for(std::uint64_t i{0u}; i < count && !bits.failed(); ++i)
+    {
+        auto step{bits.readVarint()};
+        auto mask{bits.readBits(static_cast<unsigned>(entries.size()))};
+        auto removed{bits.readBool() ? bits.readBits(static_cast<unsigned>(entries.size())) : 0u};
+        id += step;
+        if((i != 0u && step == 0u) || (mask == 0u && removed == 0u) || (mask & removed) != 0u || id > ~EntityID{0})
+        {
+            bits.setFailed();
+            break;
+        }
+
+        auto& changes{delta.mChanges};
+        auto offset{changes.mBytes.size()};
+        changes.mEntities.emplace_back(ReplicationState::EntityState{static_cast<EntityID>(id), mask, static_cast<std::uint32_t>(offset)});
+        changes.mBytes.resize(offset + this->mRegistry.stateSize(mask));
+        delta.mRemoved.emplace_back(static_cast<std::uint32_t>(removed));
+
+        char* dst{changes.mBytes.data() + offset};
+        for(std::size_t t{0u}; t < entries.size(); ++t)
+        {
+            if((mask & (1u << t)) == 0u) continue;
+            if(entries[t].decode != nullptr) entries[t].decode(bits, dst);
+            else bits.readBytes(dst, entries[t].mSize);
+            dst += entries[t].mSize;
+        }
+    }
+
+    if(bits.failed())
+    {
+        std::cerr << "ERROR: dropped a corrupt replication update." << std::endl;
+        return false;
+    }
+
+    ReceivedFrame frame;
+    frame.mSequence = sequence;
+    applyReplicationDelta(this->mRegistry, *baseline, delta, frame.mState);
+
+    auto& previous{this->mFrames[this->mLatest % replicationHistory]};
+    this->applyToWorld(this->mLatest != 0u ? previous.mState : emptyReplicationState, frame.mState);
+
+    this->mFrames[sequence % replicationHistory] = std::move(frame);
+    this->mLatest = sequence;
+    this->mServerTick = tick;
+    return true;
+}
+
+void ReplicationClient::applyToWorld(const ReplicationState& previous, const ReplicationState& next)
+{
+    auto& entries{this->mRegistry.getEntries()};
+    std::size_t p{0u};
+
+    auto despawn = [this](EntityID serverID)
+    {
+        auto it{this->mLocalIDs.find(serverID)};
+        if(it == this->mLocalIDs.end()) return;
+        if(auto* entity{this->mManager.getEntity(it->second)}) entity->destroyObj();
+        this->mLocalIDs.erase(it);
+    };
+
+    for(auto& entity : next.mEntities)
+    {
+        while(p < previous.mEntities.size() && previous.mEntities[p].mID < entity.mID) despawn(previous.mEntities[p++].mID);
+
+        const ReplicationState::EntityState* old{nullptr};
+        if(p < previous.mEntities.size() && previous.mEntities[p].mID == entity.mID) old = &previous.mEntities[p++];
+
+        Entity* local{nullptr};
+        auto it{this->mLocalIDs.find(entity.mID)};
+        if(it != this->mLocalIDs.end())
+        {
+            local = this->mManager.getEntity(it->second);
+        }
+        else
+        {
+            local = &this->mManager.addEntity();
+            this->mLocalIDs.emplace(entity.mID, local->getID());
+        }
+        // destroyed locally in the meantime, leave it be
+        if(local == nullptr || !local->isAlive()) continue;
+
+        // only touch components that actually changed, so local change tracking stays meaningful
+        const char* bytes{next.mBytes.data() + entity.mOffset};
+        for(std::size_t t{0u}; t < entries.size(); ++t)
+        {
+            std::uint32_t bit{1u << t};
+            if((entity.mMask & bit) == 0u)
+            {
+                // removed on the server
+                if(old != nullptr && (old->mMask & bit) != 0u) entries[t].remove(*local);
+                continue;
+            }
+
+            bool changed{old == nullptr || (old->mMask & bit) == 0u ||
+                std::memcmp(bytes, previous.mBytes.data() + old->mOffset + this->mRegistry.componentOffset(old->mMask, t), entries[t].mSize) != 0};
+            if(changed) entries[t].write(*local, bytes);
+            bytes += entries[t].mSize;
+        }
+    }
+
+    while(p < previous.mEntities.size()) despawn(previous.mEntities[p++].mID);
+}
+
+void ReplicationClient::writeAck(std::vector<char>& packet) const
+{
+    packet.clear();
+    BinaryWriter out{packet};
+    out.write(replicationAckPacket);
+    out.write(this->mLatest);
+}
+
+EntityID ReplicationClient::getLocalID(EntityID serverID) const
+{
+    auto it{this->mLocalIDs.find(serverID)};
+    return it == this->mLocalIDs.end() ? nullEntity : it->second;
+}
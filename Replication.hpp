@@ -0,0 +1,306 @@
+#ifndef REPLICATION_H
+#define REPLICATION_H
+
+#include "ECS.hpp"
+#include "BinaryStream.hpp"
+#include "BitStream.hpp"
+#include "SpatialGrid.hpp"
+
+#include <unordered_map>
+
+// == REPLICATION ==
+// the server captures the replicated components of its world once per tick and sends every
+// client the difference between that state and the last state the client acknowledged
+// (only changed components of changed entities, plus despawns)
+// until an ack arrives every update repeats all changes since that baseline, so a lost
+// datagram costs nothing but latency and no resends are needed
+// the classes below only produce/consume byte buffers, NetChannel moves them over udp
+constexpr std::size_t replicationHistory{32};       // frames kept for delta baselines (both sides)
+constexpr std::size_t replicationMaxDatagram{1200}; // stay below common MTUs
+constexpr std::size_t maxReplicatedTypes{32};       // component presence is a 32 bit mask
+
+constexpr std::uint8_t replicationUpdatePacket{1u};
+constexpr std::uint8_t replicationAckPacket{2u};
+
+struct ReplicationRule
+{
+    std::uint8_t mPriority{1u};     // changes with a higher priority go first when the budget is short
+    std::uint16_t mInterval{1u};    // only send changes every 'mInterval' server ticks
+};
+
+// == QUANTIZATION SCHEMAS ==
+// components are sent as raw bytes unless they declare how to quantize their fields:
+//     template<> struct ComponentQuantizer<MyComponent>
+//     {
+//         static constexpr bool quantized{true};
+//         static void write(BitWriter& out, const MyComponent& c) { out.writeFloat(c.x, 0.0f, 1024.0f, 16u); ... }
+//         static void read(BitReader& in, MyComponent& c) { c.x = in.readFloat(0.0f, 1024.0f, 16u); ... }
+//     };
+// both sides store the decoded values, so write() of a decoded value must give the same bits again
+template<typename T> struct ComponentQuantizer
+{
+    static constexpr bool quantized{false};
+};
+
+// replicated component types, must be registered in the same order on server and client
+// only plain data (pooled), trivially copyable components can be replicated
+// tags are sent as a bit of the component mask (with no data), an entity is only
+// replicated if it has at least one of the replicated data components
+class ReplicationRegistry
+{
+public:
+struct Entry
+{
+    ComponentID mTypeID;
+    std::uint32_t mSize;    // 0 for tags
+    bool mTag;
+    ReplicationRule mRule;
+    const void* (*read)(const BaseComponentPool& pool, EntityID id);
+    void (*write)(Entity& entity, const char* bytes);
+    void (*remove)(Entity& entity);
+    // quantized types only (nullptr = raw bytes)
+    void (*encode)(BitWriter& out, const char* bytes);
+    void (*decode)(BitReader& in, char* bytes);
+};
+
+private:
+std::vector<Entry> mEntries {};
+
+public:
+template<typename T> void replicate(ReplicationRule rule = ReplicationRule{})
+{
+    static_assert(isPooledComponent<T> && "ERROR: heap components (derived from Component) can not be replicated.");
+    static_assert(std::is_trivially_copyable<T>::value && "ERROR: replicated components must be trivially copyable.");
+    static_assert(!isSharedComponent<T> && "ERROR: shared component handles only mean something to their own manager.");
+    assert(mEntries.size() < maxReplicatedTypes && "ERROR: too many replicated component types.");
+    assert(rule.mInterval != 0u && "ERROR: replication interval must be at least 1.");
+    assert(sizeof(T) + 64u <= replicationMaxDatagram && "ERROR: replicated component does not fit a datagram.");
+
+    Entry entry;
+    entry.mTypeID = getComponentTypeID<T>();
+    entry.mSize = isTagComponent<T> ? 0u : static_cast<std::uint32_t>(sizeof(T));
+    entry.mTag = isTagComponent<T>;
+    entry.mRule = rule;
+    entry.read = [](const BaseComponentPool& pool, EntityID id) -> const void*
+    {
+        if constexpr(isTagComponent<T>) return nullptr;
+        else return &static_cast<const ComponentPool<T>&>(pool).get(id);
+    };
+    entry.write = [](Entity& entity, const char* bytes)
+    {
+        if constexpr(isTagComponent<T>)
+        {
+            if(!entity.hasComponent<T>()) entity.addComponent<T>();
+        }
+        else if(entity.hasComponent<T>())
+        {
+            std::memcpy(&entity.getComponent<T>(), bytes, sizeof(T));
+        }
+        else
+        {
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+            std::memcpy(&storage, bytes, sizeof(T));
+            entity.addComponent<T>(*reinterpret_cast<const T*>(&storage));
+        }
+    };
+    entry.remove = [](Entity& entity) { entity.removeComponent<T>(); };
+    entry.encode = nullptr;
+    entry.decode = nullptr;
+    if constexpr(ComponentQuantizer<T>::quantized)
+    {
+        static_assert(std::is_default_constructible<T>::value && "ERROR: quantized components must be default constructible.");
+        entry.encode = [](BitWriter& out, const char* bytes)
+        {
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+            std::memcpy(&storage, bytes, sizeof(T));
+            ComponentQuantizer<T>::write(out, *reinterpret_cast<const T*>(&storage));
+        };
+        entry.decode = [](BitReader& in, char* bytes)
+        {
+            T value{};
+            ComponentQuantizer<T>::read(in, value);
+            std::memcpy(bytes, &value, sizeof(T));
+        };
+    }
+    mEntries.emplace_back(entry);
+}
+
+const std::vector<Entry>& getEntries() const noexcept { return mEntries; }
+
+// bytes taken by the components in 'mask', and the offset of component 'type' among them
+std::size_t stateSize(std::uint32_t mask) const noexcept;
+std::size_t componentOffset(std::uint32_t mask, std::size_t type) const noexcept;
+};
+
+// replicated components of a set of entities, sorted by id
+// (each entity's components are stored back to back in registry order)
+struct ReplicationState
+{
+    struct EntityState
+    {
+        EntityID mID;
+        std::uint32_t mMask;    // bit i = the entity has registry entry i
+        std::uint32_t mOffset;  // into mBytes
+    };
+
+    std::vector<EntityState> mEntities {};
+    std::vector<char> mBytes {};
+
+    void clear()
+    {
+        mEntities.clear();
+        mBytes.clear();
+    }
+
+    const EntityState* find(EntityID id) const noexcept;
+};
+
+// what an update carries: ids to despawn, and for every changed entity only its changed components
+// (plus the components it lost, by their registry bits, so removed tags/components reach the client too)
+struct ReplicationDelta
+{
+    std::vector<EntityID> mDespawns {};
+    ReplicationState mChanges {};
+    std::vector<std::uint32_t> mRemoved {};     // one per mChanges entity
+
+    void clear()
+    {
+        mDespawns.clear();
+        mChanges.clear();
+        mRemoved.clear();
+    }
+};
+
+// baseline + delta -> the state the receiver ends up with
+void applyReplicationDelta(const ReplicationRegistry& registry, const ReplicationState& baseline,
+    const ReplicationDelta& delta, ReplicationState& out);
+
+class ReplicationServer
+{
+private:
+struct ClientFrame
+{
+    std::uint32_t mSequence{0u};
+    ReplicationState mState {};     // exactly what the client holds once it got this frame
+};
+
+// changes that did not fit the budget keep gaining priority until they are sent
+struct PriorityEntry
+{
+    EntityID mID{nullEntity};
+    float mValue{0.0f};
+};
+
+struct ClientState
+{
+    bool mActive{false};
+    std::uint32_t mSequence{0u};    // last sequence sent
+    std::uint32_t mAcked{0u};       // newest sequence the client confirmed (0 = none)
+    std::uint32_t mBytesPerSecond{0u};
+    float mCredit{0.0f};
+    std::vector<ClientFrame> mFrames {};
+    std::vector<PriorityEntry> mPriorities {};  // by entity index
+
+    // area of interest
+    sf::Vector2f mViewPosition {};
+    float mViewRadius{0.0f};
+    float mViewHysteresis{0.0f};
+};
+
+struct Relevant
+{
+    std::uint32_t mEntity;          // into mCurrent
+    float mRelevance;               // (0, 1], scales how fast priority accumulates
+};
+
+struct Candidate
+{
+    std::size_t mEntity;            // into mCurrent
+    std::uint32_t mMask;            // components to send
+    std::uint32_t mRemoved;         // components the client has but the entity lost
+    float mPriority;
+    std::size_t mSize;
+};
+
+EntityManager& mManager;
+const ReplicationRegistry& mRegistry;
+std::vector<ClientState> mClients {};
+ReplicationState mCurrent {};
+std::uint32_t mTick{0u};
+const SpatialGrid* mInterestGrid{nullptr};
+
+// scratch, reused between calls
+std::vector<Relevant> mRelevant {};
+std::vector<char> mQuantizeScratch {};
+std::array<std::size_t, maxReplicatedTypes> mEncodedBits {};   // largest encoding of every type this tick
+std::vector<Candidate> mCandidates {};
+ReplicationDelta mDelta {};
+
+const ReplicationState* getBaseline(const ClientState& client) const noexcept;
+void gatherRelevant(const ClientState& client);
+float& getPriority(ClientState& client, EntityID id);
+
+public:
+ReplicationServer(EntityManager& manager, const ReplicationRegistry& registry) : mManager{manager}, mRegistry{registry} {}
+
+// returns the client slot (freed slots are reused)
+std::size_t addClient(std::uint32_t bytesPerSecond);
+void removeClient(std::size_t client);
+void setBandwidth(std::size_t client, std::uint32_t bytesPerSecond);
+
+// == INTEREST MANAGEMENT ==
+// with a grid set, a client only receives entities within its view radius
+// (found through the grid, so the cost depends on how crowded the view is, not on the world)
+// entities keep being sent until they are 'hysteresis' past the radius, so nothing flickers at the edge
+// entities the grid does not know about are not sent at all, nullptr sends everything to everyone
+// the grid has to be rebuilt by the game every tick, before the updates are written
+void setInterestGrid(const SpatialGrid* grid) noexcept { mInterestGrid = grid; }
+void setViewer(std::size_t client, sf::Vector2f position, float radius, float hysteresis);
+
+// read the replicated components of the world, once per server tick before writing updates
+void captureState();
+std::uint32_t getTick() const noexcept { return mTick; }
+
+// build the next update for a client into 'packet' (overwritten)
+// false if the client is out of bandwidth credit this time, send nothing then
+bool writeUpdate(std::size_t client, float dt, std::vector<char>& packet);
+bool readAck(std::size_t client, const char* data, std::size_t size);
+
+std::uint32_t getAckedSequence(std::size_t client) const { return mClients[client].mAcked; }
+};
+
+class ReplicationClient
+{
+private:
+struct ReceivedFrame
+{
+    std::uint32_t mSequence{0u};
+    ReplicationState mState {};
+};
+
+EntityManager& mManager;
+const ReplicationRegistry& mRegistry;
+std::vector<ReceivedFrame> mFrames;
+std::uint32_t mLatest{0u};          // newest sequence received, its state is what the world shows
+std::uint32_t mServerTick{0u};
+std::unordered_map<EntityID, EntityID> mLocalIDs {};   // server id -> local entity
+ReplicationDelta mDelta {};
+
+void applyToWorld(const ReplicationState& previous, const ReplicationState& next);
+
+public:
+ReplicationClient(EntityManager& manager, const ReplicationRegistry& registry)
+    : mManager{manager}, mRegistry{registry}, mFrames(replicationHistory) {}
+
+// false if the packet is corrupt or its baseline is no longer known (it is dropped then)
+bool readUpdate(const char* data, std::size_t size);
+// cheap enough to send after every received update, acks are cumulative
+void writeAck(std::vector<char>& packet) const;
+
+std::uint32_t getLatestSequence() const noexcept { return mLatest; }
+std::uint32_t getServerTick() const noexcept { return mServerTick; }
+// local entity mirroring a server entity (nullEntity if it is not replicated here)
+EntityID getLocalID(EntityID serverID) const;
+};
+
+#endif // REPLICATION_H
@@ -0,0 +1,118 @@
+#include "Rollback.hpp"
+
+void RollbackBuffer::save(EntityManager& manager, std::uint32_t tick)
+{
+    // nothing is swept here (save may run mid-update), entities destroyed this tick are left out
+    // and their slots saved as free, the state is the one the next refresh() leaves behind
+    auto& frame{this->mFrames[tick % this->mFrames.size()]};
+    frame.mValid = true;
+    frame.mTick = tick;
+
+    frame.mEntities.clear();
+    frame.mGroups.clear();
+    frame.mTags.clear();
+    frame.mDisabled.clear();
+    bool hasDead{false};
+    for(auto& entity : manager.getEntities())
+    {
+        if(!entity->isAlive())
+        {
+            hasDead = true;
+            continue;
+        }
+
+        auto disabled{entity->getSignature() & ~entity->getEnabledSignature()};
+        frame.mEntities.emplace_back(entity->getID());
+        frame.mGroups.emplace_back(static_cast<std::uint32_t>(entity->getGroups().to_ulong()));
+        frame.mTags.emplace_back(static_cast<std::uint32_t>((entity->getSignature() & this->mTagTypes).to_ulong()));
+        frame.mDisabled.emplace_back(static_cast<std::uint32_t>((disabled & this->mTrackedTypes).to_ulong()));
+    }
+    manager.saveAllocator(frame.mAllocator);
+    manager.saveRelations(frame.mRelations);
+
+    frame.mColumns.resize(this->mTracks.size());
+    for(std::size_t t{0u}; t < this->mTracks.size(); ++t) this->mTracks[t].save(manager, frame.mColumns[t]);
+
+    // the dead still own their pooled components until the sweep, drop those from the columns
+    if(!hasDead) return;
+    for(auto& column : frame.mColumns)
+    {
+        if(column.mCount == 0u) continue;
+
+        auto size{column.mData.size() / column.mCount};
+        std::size_t kept{0u};
+        for(std::size_t i{0u}; i < column.mCount; ++i)
+        {
+            if(!manager.getEntity(column.mOwners[i])->isAlive()) continue;
+            if(kept != i)
+            {
+                column.mOwners[kept] = column.mOwners[i];
+                std::memcpy(column.mData.data() + kept * size, column.mData.data() + i * size, size);
+            }
+            ++kept;
+        }
+        column.mCount = kept;
+        column.mOwners.resize(kept);
+        column.mData.resize(kept * size);
+    }
+}
+
+bool RollbackBuffer::restore(EntityManager& manager, std::uint32_t tick)
+{
+    if(!this->hasFrame(tick)) return false;
+    auto& frame{this->mFrames[tick % this->mFrames.size()]};
+
+    // 1. destroy whatever was not alive back then
+    auto& slots{this->mSlotScratch};
+    std::fill(slots.begin(), slots.end(), nullEntity);
+    for(auto id : frame.mEntities)
+    {
+        auto index{getEntityIndex(id)};
+        if(index >= slots.size()) slots.resize(index + 1u, nullEntity);
+        slots[index] = id;
+    }
+    for(auto& entity : manager.getEntities())
+    {
+        auto index{getEntityIndex(entity->getID())};
+        if(index >= slots.size() || slots[index] != entity->getID()) entity->destroyObj();
+    }
+    manager.refresh();
+
+    // 2. bring back what has been destroyed since, with the same ids, groups and tags
+    // (then the allocator and the relation pairs as they were)
+    for(std::size_t i{0u}; i < frame.mEntities.size(); ++i)
+    {
+        auto* entity{manager.getEntity(frame.mEntities[i])};
+        if(entity == nullptr) entity = &manager.addEntityWithID(frame.mEntities[i]);
+
+        GroupBitset groups{frame.mGroups[i]};
+        for(GroupID group{0u}; group < maxGroups; ++group)
+        {
+            if(groups[group] == entity->hasGroup(group)) continue;
+            if(groups[group]) entity->addGroup(group);
+            else entity->deleteGroup(group);
+        }
+        entity->restoreTags(this->mTagTypes, ComponentBitset{frame.mTags[i]});
+    }
+    manager.restoreAllocator(frame.mAllocator);
+    manager.restoreRelations(frame.mRelations);
+
+    // 3. component columns
+    for(std::size_t t{0u}; t < this->mTracks.size(); ++t) this->mTracks[t].restore(manager, frame.mColumns[t]);
+
+    // 4. which tracked components were disabled (they all exist again by now)
+    for(std::size_t i{0u}; i < frame.mEntities.size(); ++i)
+    {
+        auto& entity{*manager.getEntity(frame.mEntities[i])};
+        auto types{entity.getSignature() & this->mTrackedTypes};
+        if(types.none()) continue;
+
+        ComponentBitset disabled{frame.mDisabled[i]};
+        for(ComponentID id{0u}; id < maxComponents; ++id)
+        {
+            if(types[id]) entity.setComponentEnabled(id, !disabled[id]);
+        }
+    }
+    manager.markStructureChanged();
+    return true;
+}
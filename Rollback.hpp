@@ -0,0 +1,134 @@
+#ifndef ROLLBACK_H
+#define ROLLBACK_H
+
+#include "ECS.hpp"
+
+#include <cstring>
+
+// == ROLLBACK ==
+// keeps the simulation state of the last N ticks so a late input can be applied
+// where it belongs: restore that tick, then step forward again (resimulate)
+// the state is the set of live entities (with their groups, tracked tags and which tracked components
+// are disabled), the id allocator, the relation pairs and every tracked pooled component column,
+// so saving and restoring a tick is a handful of memcpys
+// frame buffers keep their capacity, after the first lap of the ring nothing is allocated
+// heap components (derived from Component) and untracked pooled types are not part of the state and
+// are left alone, an entity recreated by restore() does not get its heap components back
+class RollbackBuffer
+{
+private:
+struct Column
+{
+    std::size_t mCount{0u};
+    std::vector<EntityID> mOwners {};
+    std::vector<char> mData {};
+};
+
+struct Frame
+{
+    bool mValid{false};
+    std::uint32_t mTick{0u};
+    std::vector<EntityID> mEntities {};
+    std::vector<std::uint32_t> mGroups {};
+    std::vector<std::uint32_t> mTags {};    // tracked tag bits of every entity
+    std::vector<std::uint32_t> mDisabled {}; // tracked disabled bits of every entity
+    EntityManager::AllocatorState mAllocator {};
+    EntityManager::RelationState mRelations {};
+    std::vector<Column> mColumns {};
+};
+
+struct Track
+{
+    ComponentID mTypeID;
+    void (*save)(EntityManager& manager, Column& column);
+    void (*restore)(EntityManager& manager, const Column& column);
+};
+
+std::vector<Frame> mFrames;
+std::vector<Track> mTracks {};
+ComponentBitset mTagTypes {};
+ComponentBitset mTrackedTypes {};
+std::vector<EntityID> mSlotScratch {};  // entity index -> id that is alive in the frame being restored
+
+public:
+RollbackBuffer(std::size_t frameCount) : mFrames(frameCount)
+{
+    assert(frameCount > 0u && "ERROR: rollback needs at least one frame.");
+}
+
+// pooled, trivially copyable component types that are part of the simulation state
+// (register them all before the first save; tags are kept as a bit per entity)
+template<typename T> void track()
+{
+    static_assert(isPooledComponent<T> && "ERROR: heap components (derived from Component) can not be rolled back.");
+    static_assert(std::is_trivially_copyable<T>::value && "ERROR: rolled back components must be trivially copyable.");
+    static_assert(!isSharedComponent<T> && "ERROR: shared component handles only mean something to their own manager.");
+
+    for(auto& frame : mFrames) frame.mValid = false;
+    mTrackedTypes.set(getComponentTypeID<T>());
+    if constexpr(isTagComponent<T>)
+    {
+        mTagTypes.set(getComponentTypeID<T>());
+    }
+    else
+    {
+        Track entry;
+        entry.mTypeID = getComponentTypeID<T>();
+        entry.save = [](EntityManager& manager, Column& column)
+        {
+            const auto& pool{manager.getPool<T>()};
+            column.mCount = pool.size();
+            column.mOwners.assign(pool.owners(), pool.owners() + pool.size());
+            column.mData.resize(pool.size() * sizeof(T));
+            if(pool.size() != 0u) std::memcpy(column.mData.data(), pool.data(), pool.size() * sizeof(T));
+        };
+        entry.restore = [](EntityManager& manager, const Column& column)
+        {
+            auto id{getComponentTypeID<T>()};
+            auto& pool{manager.getPool<T>()};
+            manager.clearPoolOwners(id);
+            pool.resize(column.mCount);
+            if(column.mCount != 0u)
+            {
+                std::memcpy(pool.owners(), column.mOwners.data(), column.mCount * sizeof(EntityID));
+                std::memcpy(pool.data(), column.mData.data(), column.mCount * sizeof(T));
+            }
+            pool.rebuildIndex();
+            manager.markPoolOwners(id);
+        };
+        mTracks.emplace_back(entry);
+    }
+}
+
+// store the state of 'tick', overwriting the oldest frame
+// (safe to call from a system or component update: nothing is swept, entities destroyed but not
+// swept yet are saved as already gone)
+void save(EntityManager& manager, std::uint32_t tick);
+// bring the manager back to 'tick', false if it is no longer (or was never) in the ring
+// entities that were destroyed since are recreated with their old ids, heap components not included
+// (restructures the manager, call it between updates, not from one)
+bool restore(EntityManager& manager, std::uint32_t tick);
+
+// restore 'from', then call step(tick) and save the result for every tick up to 'to'
+// (step has to advance the simulation exactly one tick, it must not save itself)
+template<typename F> bool resimulate(EntityManager& manager, std::uint32_t from, std::uint32_t to, F&& step)
+{
+    if(!restore(manager, from)) return false;
+    for(auto tick{from}; tick < to; ++tick)
+    {
+        step(tick);
+        save(manager, tick + 1u);
+    }
+    return true;
+}
+
+bool hasFrame(std::uint32_t tick) const noexcept
+{
+    auto& frame{mFrames[tick % mFrames.size()]};
+    return frame.mValid && frame.mTick == tick;
+}
+
+std::size_t getFrameCount() const noexcept { return mFrames.size(); }
+};
+
+#endif // ROLLBACK_H
@@ -0,0 +1,286 @@
+#include "Snapshot.hpp"
+
+#include <fstream>
+
+constexpr std::uint32_t snapshotMagic{0x454C4F56u}; // "VOLE"
+constexpr std::uint32_t snapshotVersion{4u};
+
+// == SHARED HELPERS ==
+const SnapshotRegistry::Entry* resolveSnapshotType(const SnapshotRegistry& registry, const std::string& name, std::uint8_t kind, std::uint32_t rawSize)
+{
+    auto* entry{registry.find(name)};
+    if(entry == nullptr || entry->getKind() != kind || entry->mRawSize != rawSize)
+    {
+        std::cerr << "ERROR: snapshot component '" << name << "' is unknown or its layout changed." << std::endl;
+        return nullptr;
+    }
+    return entry;
+}
+
+void writeHeapComponents(const Entity& entity, const SnapshotRegistry& registry, BinaryWriter& out)
+{
+    // count is patched once we know how many components are registered
+    auto countOffset{out.size()};
+    out.write(std::uint8_t{0u});
+
+    std::uint8_t count{0u};
+    for(auto& component : entity.getHeapComponents())
+    {
+        auto* entry{registry.find(component->mTypeID)};
+        if(entry == nullptr || !entity.ownsComponent(*component)) continue;
+
+        out.write(static_cast<std::uint8_t>(registry.indexOf(component->mTypeID)));
+        entry->writeHeap(*component, out);
+        ++count;
+    }
+    out.patch(countOffset, count);
+}
+
+bool readHeapComponents(Entity& entity, const std::vector<const SnapshotRegistry::Entry*>& types, BinaryReader& in)
+{
+    auto count{in.read<std::uint8_t>()};
+    for(std::uint8_t c{0u}; c < count && !in.failed(); ++c)
+    {
+        auto typeIndex{in.read<std::uint8_t>()};
+        if(in.failed() || typeIndex >= types.size() || types[typeIndex]->getKind() != SnapshotHeapType)
+        {
+            in.setFailed();
+            break;
+        }
+        types[typeIndex]->readHeap(entity, in);
+    }
+    return !in.failed();
+}
+
+bool loadSnapshotParts(EntityManager& manager, const std::vector<const SnapshotRegistry::Entry*>& types,
+                       const EntityID* ids, const std::uint32_t* groups, const std::uint32_t* tags,
+                       const std::uint32_t* disabled, std::size_t entityCount, const char* heap, std::size_t heapSize, const std::vector<SnapshotColumnParts>& columns)
+{
+    assert(columns.size() == types.size() && "ERROR: one column entry per type expected.");
+    manager.clear();
+    if(types.size() > 32u) return false;
+
+    // tag mask bit -> component type
+    ComponentBitset tagTypes;
+    for(auto* type : types)
+    {
+        if(type->mTag) tagTypes.set(type->mTypeID);
+    }
+
+    // 1. entities + heap components
+    BinaryReader heapIn{heap, heapSize};
+    bool ok{true};
+    for(std::size_t i{0u}; ok && i < entityCount; ++i)
+    {
+        if(manager.getEntity(ids[i]) != nullptr)
+        {
+            ok = false;
+            break;
+        }
+
+        auto& entity{manager.addEntityWithID(ids[i])};
+        GroupBitset entityGroups{groups[i]};
+        for(GroupID group{0u}; group < maxGroups; ++group)
+        {
+            if(entityGroups[group]) entity.addGroup(group);
+        }
+        if(tagTypes.any())
+        {
+            ComponentBitset entityTags;
+            for(std::size_t t{0u}; t < types.size(); ++t)
+            {
+                if((tags[i] & (1u << t)) != 0u) entityTags.set(types[t]->mTypeID);
+            }
+            entity.restoreTags(tagTypes, entityTags);
+        }
+        if(heapSize != 0u) ok = readHeapComponents(entity, types, heapIn);
+    }
+
+    // 2. pooled columns
+    for(std::size_t i{0u}; ok && i < types.size(); ++i)
+    {
+        auto& column{columns[i]};
+        if(!types[i]->mPooled || column.mCount == 0u) continue;
+
+        BinaryReader data{column.mData, column.mDataSize};
+        ok = types[i]->readColumn(manager, column.mOwners, column.mCount, data)
+          && manager.markPoolOwners(types[i]->mTypeID);
+    }
+
+    // 3. disabled components (they all exist by now, a mask naming a missing one is corrupt)
+    for(std::size_t i{0u}; ok && i < entityCount; ++i)
+    {
+        if(disabled[i] == 0u) continue;
+
+        auto& entity{*manager.getEntity(ids[i])};
+        for(std::size_t t{0u}; ok && t < types.size(); ++t)
+        {
+            if((disabled[i] & (1u << t)) == 0u) continue;
+            ok = entity.getSignature()[types[t]->mTypeID];
+            if(ok) entity.setComponentEnabled(types[t]->mTypeID, false);
+        }
+    }
+
+    if(!ok) manager.clear();
+    return ok;
+}
+
+// == SAVE ==
+void saveSnapshot(const EntityManager& manager, const SnapshotRegistry& registry, std::vector<char>& buffer)
+{
+    buffer.clear();
+    BinaryWriter out{buffer};
+
+    // 1. header + type table (file-local type index = registry index)
+    auto& entries{registry.getEntries()};
+    out.write(snapshotMagic);
+    out.write(snapshotVersion);
+    out.write(static_cast<std::uint32_t>(entries.size()));
+    for(auto& entry : entries)
+    {
+        out.writeString(entry.mName);
+        out.write(entry.getKind());
+        out.write(entry.mRawSize);
+    }
+
+    // 2. entity ids, group, tag and disabled masks as flat arrays
+    auto& entities{manager.getEntities()};
+    out.write(static_cast<std::uint32_t>(entities.size()));
+    for(auto& entity : entities) out.write(entity->getID());
+    for(auto& entity : entities) out.write(static_cast<std::uint32_t>(entity->getGroups().to_ulong()));
+    for(auto& entity : entities) out.write(registry.getTagMask(*entity));
+    for(auto& entity : entities) out.write(registry.getDisabledMask(*entity));
+
+    // 3. heap components, serialized in entity order
+    auto heapOffset{out.size()};
+    out.write(std::uint64_t{0u});
+    for(auto& entity : entities) writeHeapComponents(*entity, registry, out);
+    out.patch(heapOffset, static_cast<std::uint64_t>(out.size() - heapOffset - sizeof(std::uint64_t)));
+
+    // 4. pooled columns (owner ids, then data), in type table order
+    for(auto& entry : entries)
+    {
+        if(!entry.mPooled) continue;
+
+        auto* pool{manager.getPool(entry.mTypeID)};
+        auto count{static_cast<std::uint64_t>(pool == nullptr ? 0u : pool->size())};
+        out.write(count);
+        if(count == 0u) continue;
+
+        out.writeBytes(pool->owners(), pool->size() * sizeof(EntityID));
+        auto sizeOffset{out.size()};
+        out.write(std::uint64_t{0u});
+        entry.writeColumn(*pool, out);
+        out.patch(sizeOffset, static_cast<std::uint64_t>(out.size() - sizeOffset - sizeof(std::uint64_t)));
+    }
+}
+
+// == LOAD ==
+bool loadSnapshot(EntityManager& manager, const SnapshotRegistry& registry, const char* data, std::size_t size)
+{
+    BinaryReader in{data, size};
+
+    if(in.read<std::uint32_t>() != snapshotMagic || in.read<std::uint32_t>() != snapshotVersion)
+    {
+        std::cerr << "ERROR: not a snapshot, or written by an incompatible version." << std::endl;
+        return false;
+    }
+
+    // 1. resolve the file's type table against the registry
+    auto typeCount{in.read<std::uint32_t>()};
+    std::vector<const SnapshotRegistry::Entry*> types(typeCount, nullptr);
+    for(auto& type : types)
+    {
+        auto name{in.readString()};
+        auto kind{in.read<std::uint8_t>()};
+        auto rawSize{in.read<std::uint32_t>()};
+
+        type = resolveSnapshotType(registry, name, kind, rawSize);
+        if(type == nullptr) return false;
+    }
+    if(in.failed()) return false;
+
+    // 2. locate the arrays, the heap stream and every column, then rebuild the world from those parts
+    auto entityCount{in.read<std::uint32_t>()};
+    std::vector<EntityID> ids;
+    std::vector<std::uint32_t> groups;
+    std::vector<std::uint32_t> tags;
+    std::vector<std::uint32_t> disabled;
+    if(!in.failed() && entityCount <= in.remaining() / (sizeof(EntityID) + 3u * sizeof(std::uint32_t)))
+    {
+        ids.resize(entityCount);
+        groups.resize(entityCount);
+        tags.resize(entityCount);
+        disabled.resize(entityCount);
+        in.readBytes(ids.data(), ids.size() * sizeof(EntityID));
+        in.readBytes(groups.data(), groups.size() * sizeof(std::uint32_t));
+        in.readBytes(tags.data(), tags.size() * sizeof(std::uint32_t));
+        in.readBytes(disabled.data(), disabled.size() * sizeof(std::uint32_t));
+    }
+    else in.setFailed();
+
+    auto heapSize{in.read<std::uint64_t>()};
+    const char* heap{in.skip(static_cast<std::size_t>(heapSize))};
+
+    std::vector<SnapshotColumnParts> columns(types.size(), SnapshotColumnParts{nullptr, 0u, nullptr, 0u});
+    for(std::size_t i{0u}; i < types.size() && !in.failed(); ++i)
+    {
+        if(!types[i]->mPooled) continue;
+
+        auto count{in.read<std::uint64_t>()};
+        if(count == 0u) continue;
+        if(count > in.remaining() / sizeof(EntityID))
+        {
+            in.setFailed();
+            break;
+        }
+
+        auto& column{columns[i]};
+        column.mOwners = in.skip(static_cast<std::size_t>(count * sizeof(EntityID)));
+        column.mCount = static_cast<std::size_t>(count);
+        auto dataSize{in.read<std::uint64_t>()};
+        if(in.failed() || dataSize > in.remaining() || (types[i]->mRawSize != 0u && dataSize != count * types[i]->mRawSize))
+        {
+            in.setFailed();
+            break;
+        }
+        column.mDataSize = static_cast<std::size_t>(dataSize);
+        column.mData = in.skip(column.mDataSize);
+    }
+
+    if(in.failed() || !loadSnapshotParts(manager, types, ids.data(), groups.data(), tags.data(), disabled.data(), ids.size(),
+                                         heap, static_cast<std::size_t>(heapSize), columns))
+    {
+        std::cerr << "ERROR: snapshot is truncated or corrupt." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// == FILE HELPERS ==
+bool saveSnapshotToFile(const EntityManager& manager, const SnapshotRegistry& registry, const std::string& path)
+{
+    std::vector<char> buffer;
+    saveSnapshot(manager, registry, buffer);
+
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    return static_cast<bool>(file);
+}
+
+bool loadSnapshotFromFile(EntityManager& manager, const SnapshotRegistry& registry, const std::string& path)
+{
+    std::ifstream file{path, std::ios::binary | std::ios::ate};
+    if(!file)
+    {
+        std::cerr << "ERROR: could not open snapshot '" << path << "'." << std::endl;
+        return false;
+    }
+
+    std::vector<char> buffer(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    if(!file) return false;
+
+    return loadSnapshot(manager, registry, buffer.data(), buffer.size());
+}
@@ -0,0 +1,227 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "ECS.hpp"
+#include "BinaryStream.hpp"
+
+#include <string>
+#include <cstring>
+
+// == SERIALIZER HOOK ==
+// trivially copyable components are written as raw bytes (and whole pooled columns with one memcpy)
+// anything else (all heap components) must specialise this template, e.g.
+//
+//     template<> struct ComponentSerializer<MyComponent>
+//     {
+//         static void write(BinaryWriter& out, const MyComponent& c) { ... }
+//         static void read(BinaryReader& in, MyComponent& c) { ... }
+//     };
+template<typename T> struct ComponentSerializer
+{
+    static_assert(std::is_trivially_copyable<T>::value && "ERROR: specialise ComponentSerializer<T> for this component.");
+
+    static void write(BinaryWriter& out, const T& component)
+    {
+        out.write(component);
+    }
+
+    static void read(BinaryReader& in, T& component)
+    {
+        in.readBytes(&component, sizeof(T));
+    }
+};
+
+
+// == SNAPSHOT REGISTRY ==
+// component type IDs depend on instanciation order, so snapshots refer to types by a stable name
+// only registered component types are saved (tags and disabled components are saved as per-entity bitmasks
+// of type table indices)
+enum SnapshotTypeKind : std::uint8_t
+{
+    SnapshotHeapType,
+    SnapshotPooledType,
+    SnapshotTagType
+};
+
+class SnapshotRegistry
+{
+public:
+struct Entry
+{
+    std::string mName;
+    ComponentID mTypeID;
+    bool mPooled;   // has a column (tags do not)
+    bool mTag;
+    // sizeof(T) for columns that are copied in bulk, 0 if every element goes through the serializer
+    std::uint32_t mRawSize;
+
+    // column data only, the owner ids are written/passed in by the caller
+    void (*writeColumn)(const BaseComponentPool& pool, BinaryWriter& out);
+    bool (*readColumn)(EntityManager& manager, const char* owners, std::size_t count, BinaryReader& in);
+    void (*writeHeap)(const Component& component, BinaryWriter& out);
+    void (*readHeap)(Entity& entity, BinaryReader& in);
+
+    std::uint8_t getKind() const noexcept { return mPooled ? SnapshotPooledType : (mTag ? SnapshotTagType : SnapshotHeapType); }
+};
+
+private:
+std::vector<Entry> mEntries {};
+std::array<int, maxComponents> mEntryByType {};
+
+template<typename T> static void writeColumnImpl(const BaseComponentPool& base, BinaryWriter& out)
+{
+    auto& pool{static_cast<const ComponentPool<T>&>(base)};
+    if constexpr(std::is_trivially_copyable<T>::value)
+    {
+        out.writeBytes(pool.data(), pool.size() * sizeof(T));
+    }
+    else
+    {
+        for(std::size_t i{0u}; i < pool.size(); ++i) ComponentSerializer<T>::write(out, pool.data()[i]);
+    }
+}
+
+template<typename T> static bool readColumnImpl(EntityManager& manager, const char* owners, std::size_t count, BinaryReader& in)
+{
+    auto& pool{manager.getPool<T>()};
+    pool.resize(count);
+    std::memcpy(pool.owners(), owners, count * sizeof(EntityID));
+
+    if constexpr(std::is_trivially_copyable<T>::value)
+    {
+        if(!in.readBytes(pool.data(), count * sizeof(T))) return false;
+    }
+    else
+    {
+        // (mutable data() marks every chunk, once is enough)
+        auto* dense{pool.data()};
+        for(std::size_t i{0u}; i < count; ++i) ComponentSerializer<T>::read(in, dense[i]);
+    }
+
+    pool.rebuildIndex();
+    return !in.failed();
+}
+
+template<typename T> static void writeHeapImpl(const Component& component, BinaryWriter& out)
+{
+    ComponentSerializer<T>::write(out, static_cast<const T&>(component));
+}
+
+template<typename T> static void readHeapImpl(Entity& entity, BinaryReader& in)
+{
+    ComponentSerializer<T>::read(in, entity.addComponent<T>());
+}
+
+public:
+SnapshotRegistry() { mEntryByType.fill(-1); }
+
+template<typename T> void registerComponent(const std::string& name)
+{
+    static_assert(!isSharedComponent<T> && "ERROR: shared component handles only mean something to their own manager.");
+    assert(find(name) == nullptr && "ERROR: component name already registered.");
+    assert(mEntries.size() < 32u && "ERROR: snapshot tag masks hold 32 types.");
+
+    Entry entry{name, getComponentTypeID<T>(), isPooledComponent<T> && !isTagComponent<T>, isTagComponent<T>, 0u, nullptr, nullptr, nullptr, nullptr};
+    if constexpr(isTagComponent<T>)
+    {
+        // the bit in the entity's tag mask is all there is to it
+    }
+    else if constexpr(isPooledComponent<T>)
+    {
+        if(std::is_trivially_copyable<T>::value) entry.mRawSize = sizeof(T);
+        entry.writeColumn = &writeColumnImpl<T>;
+        entry.readColumn = &readColumnImpl<T>;
+    }
+    else
+    {
+        static_assert(std::is_default_constructible<T>::value && "ERROR: heap components must be default constructible to be loaded.");
+        entry.writeHeap = &writeHeapImpl<T>;
+        entry.readHeap = &readHeapImpl<T>;
+    }
+
+    mEntryByType[entry.mTypeID] = static_cast<int>(mEntries.size());
+    mEntries.emplace_back(std::move(entry));
+}
+
+const Entry* find(ComponentID id) const noexcept
+{
+    return mEntryByType[id] < 0 ? nullptr : &mEntries[mEntryByType[id]];
+}
+
+const Entry* find(const std::string& name) const noexcept
+{
+    for(auto& entry : mEntries)
+    {
+        if(entry.mName == name) return &entry;
+    }
+    return nullptr;
+}
+
+int indexOf(ComponentID id) const noexcept { return mEntryByType[id]; }
+const std::vector<Entry>& getEntries() const noexcept { return mEntries; }
+
+// bit i = the entity has the tag of registry entry i
+std::uint32_t getTagMask(const Entity& entity) const noexcept
+{
+    std::uint32_t mask{0u};
+    for(std::size_t i{0u}; i < mEntries.size(); ++i)
+    {
+        if(mEntries[i].mTag && entity.getSignature()[mEntries[i].mTypeID]) mask |= 1u << i;
+    }
+    return mask;
+}
+
+// bit i = the entity has the component of registry entry i but it is disabled
+std::uint32_t getDisabledMask(const Entity& entity) const noexcept
+{
+    auto disabled{entity.getSignature() & ~entity.getEnabledSignature()};
+    std::uint32_t mask{0u};
+    for(std::size_t i{0u}; i < mEntries.size(); ++i)
+    {
+        if(disabled[mEntries[i].mTypeID]) mask |= 1u << i;
+    }
+    return mask;
+}
+};
+
+
+// == SHARED SNAPSHOT HELPERS ==
+// look up a type from a snapshot's type table, fails if it is unknown or its layout changed
+const SnapshotRegistry::Entry* resolveSnapshotType(const SnapshotRegistry& registry, const std::string& name, std::uint8_t kind, std::uint32_t rawSize);
+
+// an entity's registered heap components in the order they were added (count + [type index, payload]...)
+void writeHeapComponents(const Entity& entity, const SnapshotRegistry& registry, BinaryWriter& out);
+bool readHeapComponents(Entity& entity, const std::vector<const SnapshotRegistry::Entry*>& types, BinaryReader& in);
+
+// a pooled column once it has been located in memory (mCount == 0 for heap component types)
+struct SnapshotColumnParts
+{
+    const char* mOwners;
+    std::size_t mCount;
+    const char* mData;
+    std::size_t mDataSize;
+};
+
+// rebuild a world from flat entity arrays, a heap component stream and one column per type
+// (an empty heap stream means no heap components were saved)
+// tag and disabled masks refer to 'types' by index (see SnapshotRegistry::getTagMask/getDisabledMask),
+// components are disabled again once everything is loaded
+// clears the manager first, and again if anything turns out to be corrupt
+bool loadSnapshotParts(EntityManager& manager, const std::vector<const SnapshotRegistry::Entry*>& types,
+                       const EntityID* ids, const std::uint32_t* groups, const std::uint32_t* tags,
+                       const std::uint32_t* disabled, std::size_t entityCount,
+                       const char* heap, std::size_t heapSize, const std::vector<SnapshotColumnParts>& columns);
+
+
+// == SNAPSHOT SAVE/LOAD ==
+// a snapshot holds the entity ids, group, tag and disabled masks, the heap components of every entity
+// (in the order they were added) and one column per registered pooled component type
+// loading locates those parts in the buffer and hands them to loadSnapshotParts()
+// loading clears the manager first, signatures are rebuilt from the restored components
+void saveSnapshot(const EntityManager& manager, const SnapshotRegistry& registry, std::vector<char>& buffer);
+bool loadSnapshot(EntityManager& manager, const SnapshotRegistry& registry, const char* data, std::size_t size);
+
+bool saveSnapshotToFile(const EntityManager& manager, const SnapshotRegistry& registry, const std::string& path);
+bool loadSnapshotFromFile(EntityManager& manager, const SnapshotRegistry& registry, const std::string& path);
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,54 @@
+#include "SpatialGrid.hpp"
+
+SpatialGrid::SpatialGrid(const sf::FloatRect& bounds, float cellSize)
+    : mBounds{bounds}, mCellSize{cellSize}
+{
+    assert(cellSize > 0.0f && bounds.width > 0.0f && bounds.height > 0.0f && "ERROR: invalid spatial grid dimensions.");
+    this->mColumns = static_cast<std::uint32_t>(std::ceil(bounds.width / cellSize));
+    this->mRows = static_cast<std::uint32_t>(std::ceil(bounds.height / cellSize));
+    this->mCellStart.assign(this->mColumns * this->mRows + 1u, 0u);
+}
+
+std::uint32_t SpatialGrid::cellColumn(float x) const noexcept
+{
+    float column{std::floor((x - this->mBounds.left) / this->mCellSize)};
+    if(!(column > 0.0f)) return 0u;
+    return std::min(static_cast<std::uint32_t>(column), this->mColumns - 1u);
+}
+
+std::uint32_t SpatialGrid::cellRow(float y) const noexcept
+{
+    float row{std::floor((y - this->mBounds.top) / this->mCellSize)};
+    if(!(row > 0.0f)) return 0u;
+    return std::min(static_cast<std::uint32_t>(row), this->mRows - 1u);
+}
+
+void SpatialGrid::build(const EntityID* ids, const sf::Vector2f* positions, std::size_t count)
+{
+    auto& start{this->mCellStart};
+    std::fill(start.begin(), start.end(), 0u);
+
+    // 1. count per cell
+    this->mCells.resize(count);
+    for(std::size_t i{0u}; i < count; ++i)
+    {
+        auto cell{cellRow(positions[i].y) * this->mColumns + cellColumn(positions[i].x)};
+        this->mCells[i] = cell;
+        ++start[cell + 1u];
+    }
+
+    // 2. prefix sum -> first slot of every cell
+    for(std::size_t cell{1u}; cell < start.size(); ++cell) start[cell] += start[cell - 1u];
+
+    // 3. scatter (start[cell] is used as the write cursor and restored afterwards)
+    this->mIDs.resize(count);
+    this->mPositions.resize(count);
+    for(std::size_t i{0u}; i < count; ++i)
+    {
+        auto slot{start[this->mCells[i]]++};
+        this->mIDs[slot] = ids[i];
+        this->mPositions[slot] = positions[i];
+    }
+    for(std::size_t cell{start.size() - 1u}; cell > 0u; --cell) start[cell] = start[cell - 1u];
+    start[0] = 0u;
+}
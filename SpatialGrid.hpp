@@ -0,0 +1,74 @@
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+#include "ECS.hpp"
+
+#include <cmath>
+
+// == SPATIAL INDEX ==
+// uniform grid over a fixed area, rebuilt from scratch every tick
+// entries are counting-sorted by cell into flat arrays, so building is two linear passes
+// and a query only walks the cells overlapping its circle
+// (positions outside the bounds are clamped into the border cells)
+class SpatialGrid
+{
+private:
+sf::FloatRect mBounds;
+float mCellSize;
+std::uint32_t mColumns;
+std::uint32_t mRows;
+
+std::vector<std::uint32_t> mCellStart {};   // entries of cell i are [mCellStart[i], mCellStart[i + 1])
+std::vector<EntityID> mIDs {};
+std::vector<sf::Vector2f> mPositions {};
+std::vector<std::uint32_t> mCells {};       // scratch, cell of every input entry
+
+std::uint32_t cellColumn(float x) const noexcept;
+std::uint32_t cellRow(float y) const noexcept;
+
+public:
+SpatialGrid(const sf::FloatRect& bounds, float cellSize);
+
+void build(const EntityID* ids, const sf::Vector2f* positions, std::size_t count);
+
+// index every owner of a pooled component, 'getPosition' maps the component to a position
+template<typename T, typename F> void build(const ComponentPool<T>& pool, F&& getPosition)
+{
+    std::vector<sf::Vector2f> positions;
+    positions.reserve(pool.size());
+    for(std::size_t i{0u}; i < pool.size(); ++i) positions.emplace_back(getPosition(pool.data()[i]));
+    build(pool.owners(), positions.data(), positions.size());
+}
+
+// calls visit(EntityID, float distanceSquared) for every entry within 'radius' of 'center'
+template<typename F> void query(sf::Vector2f center, float radius, F&& visit) const
+{
+    if(mIDs.empty()) return;
+
+    auto firstColumn{cellColumn(center.x - radius)};
+    auto lastColumn{cellColumn(center.x + radius)};
+    auto firstRow{cellRow(center.y - radius)};
+    auto lastRow{cellRow(center.y + radius)};
+    float radiusSquared{radius * radius};
+
+    for(auto row{firstRow}; row <= lastRow; ++row)
+    {
+        // cells of one row are adjacent, so their entries form a single range
+        auto begin{mCellStart[row * mColumns + firstColumn]};
+        auto end{mCellStart[row * mColumns + lastColumn + 1u]};
+        for(auto i{begin}; i < end; ++i)
+        {
+            float dx{mPositions[i].x - center.x};
+            float dy{mPositions[i].y - center.y};
+            float distanceSquared{dx * dx + dy * dy};
+            if(distanceSquared <= radiusSquared) visit(mIDs[i], distanceSquared);
+        }
+    }
+}
+
+std::size_t size() const noexcept { return mIDs.size(); }
+const sf::FloatRect& getBounds() const noexcept { return mBounds; }
+float getCellSize() const noexcept { return mCellSize; }
+};
+
+#endif // SPATIALGRID_H
@@ -0,0 +1,315 @@
+#include "Telemetry.hpp"
+
+#include <cstdio>
+#include <cstdarg>
+#include <cstring>
+#include <fstream>
+
+#include <SFML/System/Sleep.hpp>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define PSAPI_VERSION 2
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#endif
+
+constexpr std::size_t telemetryMaxConnections{8};
+constexpr std::size_t telemetryMaxRequest{4096};
+constexpr float telemetryConnectionTimeout{5.0f};
+
+// resident set size of the process, 0 where it is not known
+static std::uint64_t residentMemoryBytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return counters.WorkingSetSize;
+    return 0u;
+#elif defined(__linux__)
+    std::ifstream statm{"/proc/self/statm"};
+    std::uint64_t size{0u};
+    std::uint64_t resident{0u};
+    if(!(statm >> size >> resident)) return 0u;
+    return resident * static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+#else
+    return 0u;
+#endif
+}
+
+static void appendFormat(std::string& out, const char* format, ...)
+{
+    char line[256];
+    va_list args;
+    va_start(args, format);
+    int length{std::vsnprintf(line, sizeof(line), format, args)};
+    va_end(args);
+    if(length > 0) out.append(line, std::min(static_cast<std::size_t>(length), sizeof(line) - 1u));
+}
+
+// == METRICS ==
+void TelemetryMetrics::recordFrame(float seconds)
+{
+    auto frame{this->mFrameCount.load(std::memory_order_relaxed)};
+    this->mFrameMicroseconds[frame % telemetryFrameWindow].store(static_cast<std::uint32_t>(seconds * 1e6f), std::memory_order_relaxed);
+    this->mFrameCount.store(frame + 1u, std::memory_order_release);
+}
+
+void TelemetryMetrics::recordEntities(EntityManager& manager)
+{
+    this->mEntityCount.store(static_cast<std::uint32_t>(manager.getEntityCount()), std::memory_order_relaxed);
+    for(GroupID group{0u}; group < maxGroups; ++group)
+    {
+        this->mGroupCounts[group].store(static_cast<std::uint32_t>(manager.getEntitiesByGroup(group).size()), std::memory_order_relaxed);
+    }
+}
+
+std::size_t TelemetryMetrics::registerSystem(const std::string& name)
+{
+    auto id{this->mSystemCount.load(std::memory_order_relaxed)};
+    assert(id < maxTelemetrySystems && "ERROR: too many telemetry systems.");
+
+    // the name is complete before the new count is published
+    auto& slot{this->mSystems[id]};
+    std::strncpy(slot.mName, name.c_str(), telemetryNameLength - 1u);
+    this->mSystemCount.store(id + 1u, std::memory_order_release);
+    return id;
+}
+
+void TelemetryMetrics::recordSystem(std::size_t system, float seconds)
+{
+    auto& slot{this->mSystems[system]};
+    auto microseconds{static_cast<std::uint32_t>(seconds * 1e6f)};
+    slot.mCalls.fetch_add(1u, std::memory_order_relaxed);
+    slot.mTotalMicroseconds.fetch_add(microseconds, std::memory_order_relaxed);
+    slot.mLastMicroseconds.store(microseconds, std::memory_order_relaxed);
+}
+
+TelemetryMetrics::FrameStats TelemetryMetrics::getFrameStats() const
+{
+    FrameStats stats;
+    stats.mFrames = this->mFrameCount.load(std::memory_order_acquire);
+    auto count{static_cast<std::size_t>(std::min<std::uint64_t>(stats.mFrames, telemetryFrameWindow))};
+    if(count == 0u) return stats;
+
+    // the game loop may overwrite a slot meanwhile, a frame more or less does not matter here
+    std::array<std::uint32_t, telemetryFrameWindow> frames;
+    for(std::size_t i{0u}; i < count; ++i) frames[i] = this->mFrameMicroseconds[i].load(std::memory_order_relaxed);
+    std::sort(frames.begin(), frames.begin() + count);
+
+    auto percentile = [&](float p)
+    {
+        return static_cast<float>(frames[static_cast<std::size_t>(p * static_cast<float>(count - 1u))]) * 1e-6f;
+    };
+    stats.mP50 = percentile(0.5f);
+    stats.mP90 = percentile(0.9f);
+    stats.mP99 = percentile(0.99f);
+    stats.mMax = percentile(1.0f);
+    return stats;
+}
+
+void TelemetryMetrics::writeJson(std::string& out) const
+{
+    auto frames{this->getFrameStats()};
+    out.clear();
+    appendFormat(out, "{\"frames\":{\"count\":%llu,\"p50\":%.6f,\"p90\":%.6f,\"p99\":%.6f,\"max\":%.6f},",
+        static_cast<unsigned long long>(frames.mFrames), frames.mP50, frames.mP90, frames.mP99, frames.mMax);
+    appendFormat(out, "\"entities\":%u,\"groups\":{", this->mEntityCount.load(std::memory_order_relaxed));
+
+    bool first{true};
+    for(GroupID group{0u}; group < maxGroups; ++group)
+    {
+        auto count{this->mGroupCounts[group].load(std::memory_order_relaxed)};
+        if(count == 0u) continue;
+        appendFormat(out, "%s\"%u\":%u", first ? "" : ",", static_cast<unsigned>(group), count);
+        first = false;
+    }
+
+    out += "},\"systems\":{";
+    auto systems{this->mSystemCount.load(std::memory_order_acquire)};
+    for(std::uint32_t i{0u}; i < systems; ++i)
+    {
+        auto& slot{this->mSystems[i]};
+        appendFormat(out, "%s\"%s\":{\"calls\":%llu,\"total_seconds\":%.6f,\"last_seconds\":%.6f}", i == 0u ? "" : ",", slot.mName,
+            static_cast<unsigned long long>(slot.mCalls.load(std::memory_order_relaxed)),
+            static_cast<double>(slot.mTotalMicroseconds.load(std::memory_order_relaxed)) * 1e-6,
+            static_cast<double>(slot.mLastMicroseconds.load(std::memory_order_relaxed)) * 1e-6);
+    }
+    appendFormat(out, "},\"resident_memory_bytes\":%llu}\n", static_cast<unsigned long long>(residentMemoryBytes()));
+}
+
+void TelemetryMetrics::writePrometheus(std::string& out) const
+{
+    auto frames{this->getFrameStats()};
+    out.clear();
+    out += "# TYPE vole_frame_seconds summary\n";
+    appendFormat(out, "vole_frame_seconds{quantile=\"0.5\"} %.6f\n", frames.mP50);
+    appendFormat(out, "vole_frame_seconds{quantile=\"0.9\"} %.6f\n", frames.mP90);
+    appendFormat(out, "vole_frame_seconds{quantile=\"0.99\"} %.6f\n", frames.mP99);
+    appendFormat(out, "vole_frame_seconds{quantile=\"1\"} %.6f\n", frames.mMax);
+    appendFormat(out, "vole_frame_seconds_count %llu\n", static_cast<unsigned long long>(frames.mFrames));
+
+    out += "# TYPE vole_entities gauge\n";
+    appendFormat(out, "vole_entities %u\n", this->mEntityCount.load(std::memory_order_relaxed));
+    out += "# TYPE vole_group_entities gauge\n";
+    for(GroupID group{0u}; group < maxGroups; ++group)
+    {
+        auto count{this->mGroupCounts[group].load(std::memory_order_relaxed)};
+        if(count != 0u) appendFormat(out, "vole_group_entities{group=\"%u\"} %u\n", static_cast<unsigned>(group), count);
+    }
+
+    auto systems{this->mSystemCount.load(std::memory_order_acquire)};
+    out += "# TYPE vole_system_calls_total counter\n";
+    for(std::uint32_t i{0u}; i < systems; ++i)
+    {
+        appendFormat(out, "vole_system_calls_total{system=\"%s\"} %llu\n", this->mSystems[i].mName,
+            static_cast<unsigned long long>(this->mSystems[i].mCalls.load(std::memory_order_relaxed)));
+    }
+    out += "# TYPE vole_system_seconds_total counter\n";
+    for(std::uint32_t i{0u}; i < systems; ++i)
+    {
+        appendFormat(out, "vole_system_seconds_total{system=\"%s\"} %.6f\n", this->mSystems[i].mName,
+            static_cast<double>(this->mSystems[i].mTotalMicroseconds.load(std::memory_order_relaxed)) * 1e-6);
+    }
+    out += "# TYPE vole_system_last_seconds gauge\n";
+    for(std::uint32_t i{0u}; i < systems; ++i)
+    {
+        appendFormat(out, "vole_system_last_seconds{system=\"%s\"} %.6f\n", this->mSystems[i].mName,
+            static_cast<double>(this->mSystems[i].mLastMicroseconds.load(std::memory_order_relaxed)) * 1e-6);
+    }
+
+    out += "# TYPE vole_resident_memory_bytes gauge\n";
+    appendFormat(out, "vole_resident_memory_bytes %llu\n", static_cast<unsigned long long>(residentMemoryBytes()));
+}
+
+// == ENDPOINT ==
+TelemetryServer::~TelemetryServer()
+{
+    this->stop();
+    this->close();
+}
+
+bool TelemetryServer::listen(unsigned short port)
+{
+    if(this->mListener.listen(port, sf::IpAddress::LocalHost) != sf::Socket::Done)
+    {
+        std::cerr << "ERROR: telemetry could not listen on port " << port << "." << std::endl;
+        return false;
+    }
+    this->mListener.setBlocking(false);
+    this->mListening = true;
+    return true;
+}
+
+void TelemetryServer::close()
+{
+    this->mListener.close();
+    this->mConnections.clear();
+    this->mListening = false;
+}
+
+void TelemetryServer::respond(Connection& connection)
+{
+    // only the request line matters: "GET <path> HTTP/1.x"
+    auto& request{connection.mRequest};
+    auto pathEnd{request.find(' ', 4u)};
+    std::string path{request.compare(0u, 4u, "GET ") == 0 && pathEnd != std::string::npos ? request.substr(4u, pathEnd - 4u) : ""};
+
+    std::string body;
+    const char* status{"200 OK"};
+    const char* type{"application/json"};
+    if(path == "/metrics")
+    {
+        this->mMetrics.writePrometheus(body);
+        type = "text/plain; version=0.0.4";
+    }
+    else if(path == "/" || path == "/metrics.json")
+    {
+        this->mMetrics.writeJson(body);
+    }
+    else
+    {
+        status = "404 Not Found";
+        type = "text/plain";
+        body = "not found\n";
+    }
+
+    auto& response{connection.mResponse};
+    response.clear();
+    appendFormat(response, "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %llu\r\nConnection: close\r\n\r\n",
+        status, type, static_cast<unsigned long long>(body.size()));
+    response += body;
+    connection.mSent = 0u;
+}
+
+void TelemetryServer::poll()
+{
+    if(!this->mListening) return;
+
+    // 1. new scrapers
+    while(this->mConnections.size() < telemetryMaxConnections)
+    {
+        std::unique_ptr<sf::TcpSocket> socket{new sf::TcpSocket};
+        if(this->mListener.accept(*socket) != sf::Socket::Done) break;
+        socket->setBlocking(false);
+        Connection connection;
+        connection.mSocket = std::move(socket);
+        this->mConnections.emplace_back(std::move(connection));
+    }
+
+    // 2. read requests, write responses, as far as the sockets let us
+    for(auto& connection : this->mConnections)
+    {
+        if(connection.mResponse.empty())
+        {
+            char buffer[512];
+            std::size_t received{0u};
+            auto status{connection.mSocket->receive(buffer, sizeof(buffer), received)};
+            if(status == sf::Socket::Done) connection.mRequest.append(buffer, received);
+            else if(status != sf::Socket::NotReady) connection.mClosed = true;
+
+            if(connection.mRequest.find("\r\n\r\n") != std::string::npos) this->respond(connection);
+        }
+
+        if(!connection.mResponse.empty())
+        {
+            std::size_t sent{0u};
+            auto status{connection.mSocket->send(connection.mResponse.data() + connection.mSent, connection.mResponse.size() - connection.mSent, sent)};
+            if(status == sf::Socket::Disconnected || status == sf::Socket::Error) connection.mClosed = true;
+            connection.mSent += sent;
+        }
+    }
+
+    // 3. drop finished, broken, oversized and stale connections
+    this->mConnections.erase(std::remove_if(this->mConnections.begin(), this->mConnections.end(),
+    [](const Connection& connection)
+    {
+        bool done{!connection.mResponse.empty() && connection.mSent == connection.mResponse.size()};
+        return done || connection.mClosed || connection.mRequest.size() > telemetryMaxRequest ||
+            connection.mAge.getElapsedTime().asSeconds() > telemetryConnectionTimeout;
+    }),
+    this->mConnections.end());
+}
+
+bool TelemetryServer::start()
+{
+    if(!this->mListening || this->mRunning) return false;
+
+    this->mRunning = true;
+    this->mThread = std::thread{[this]()
+    {
+        while(this->mRunning)
+        {
+            this->poll();
+            sf::sleep(sf::milliseconds(10));
+        }
+    }};
+    return true;
+}
+
+void TelemetryServer::stop()
+{
+    this->mRunning = false;
+    if(this->mThread.joinable()) this->mThread.join();
+}
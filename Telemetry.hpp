@@ -0,0 +1,121 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "ECS.hpp"
+
+#include <atomic>
+#include <thread>
+#include <string>
+
+#include <SFML/Network/TcpListener.hpp>
+#include <SFML/Network/TcpSocket.hpp>
+
+// == TELEMETRY ==
+// the game loop writes metrics into plain atomics (relaxed, never a lock), the endpoint reads them
+// whenever a scraper asks, from the game loop (poll) or from its own thread (start)
+constexpr std::size_t telemetryFrameWindow{1024};    // frames the percentiles are computed over
+constexpr std::size_t maxTelemetrySystems{16};
+constexpr std::size_t telemetryNameLength{32};
+
+class TelemetryMetrics
+{
+public:
+struct FrameStats
+{
+    std::uint64_t mFrames{0u};      // since start
+    float mP50{0.0f};               // seconds, over the last telemetryFrameWindow frames
+    float mP90{0.0f};
+    float mP99{0.0f};
+    float mMax{0.0f};
+};
+
+private:
+struct SystemSlot
+{
+    char mName[telemetryNameLength] {};
+    std::atomic<std::uint64_t> mCalls{0u};
+    std::atomic<std::uint64_t> mTotalMicroseconds{0u};
+    std::atomic<std::uint32_t> mLastMicroseconds{0u};
+};
+
+std::array<std::atomic<std::uint32_t>, telemetryFrameWindow> mFrameMicroseconds {};
+std::atomic<std::uint64_t> mFrameCount{0u};
+
+std::atomic<std::uint32_t> mEntityCount{0u};
+std::array<std::atomic<std::uint32_t>, maxGroups> mGroupCounts {};
+
+std::array<SystemSlot, maxTelemetrySystems> mSystems {};
+std::atomic<std::uint32_t> mSystemCount{0u};
+
+public:
+// == written by the game loop ==
+void recordFrame(float seconds);
+void recordEntities(EntityManager& manager);
+
+// returns the id to time the system with (register everything before serving starts)
+std::size_t registerSystem(const std::string& name);
+void recordSystem(std::size_t system, float seconds);
+
+// == read by the endpoint ==
+FrameStats getFrameStats() const;
+void writeJson(std::string& out) const;
+void writePrometheus(std::string& out) const;
+};
+
+// times the enclosing scope as one call of a system
+class ScopedSystemTimer
+{
+private:
+TelemetryMetrics& mMetrics;
+std::size_t mSystem;
+sf::Clock mClock;
+
+public:
+ScopedSystemTimer(TelemetryMetrics& metrics, std::size_t system) : mMetrics{metrics}, mSystem{system} {}
+~ScopedSystemTimer() { mMetrics.recordSystem(mSystem, mClock.getElapsedTime().asSeconds()); }
+};
+
+// minimal http endpoint on localhost:
+//     GET /metrics       prometheus text format
+//     GET /metrics.json  json (so does GET /)
+// every socket is non-blocking, a slow or stuck scraper is dropped after a timeout
+class TelemetryServer : sf::NonCopyable
+{
+private:
+struct Connection
+{
+    std::unique_ptr<sf::TcpSocket> mSocket {};
+    std::string mRequest {};
+    std::string mResponse {};
+    std::size_t mSent{0u};
+    bool mClosed{false};
+    sf::Clock mAge;
+};
+
+const TelemetryMetrics& mMetrics;
+sf::TcpListener mListener;
+bool mListening{false};
+std::vector<Connection> mConnections {};
+
+std::thread mThread;
+std::atomic<bool> mRunning{false};
+
+void respond(Connection& connection);
+
+public:
+TelemetryServer(const TelemetryMetrics& metrics) : mMetrics{metrics} {}
+~TelemetryServer();
+
+// bound to 127.0.0.1 only
+bool listen(unsigned short port);
+void close();
+
+// accept, read and answer whatever is ready, never waits
+void poll();
+
+// alternatively keep polling from a background thread (the game loop then only touches the metrics)
+bool start();
+void stop();
+};
+
+#endif // TELEMETRY_H
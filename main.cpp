@@ -1,4 +1,9 @@
 #include "Game.hpp"
+#include "ECS.hpp"
+#include "Snapshot.hpp"
+#include "Replay.hpp"
+#include "Telemetry.hpp"
+#include "RenderBatch.hpp"
 
 #include <iostream>
 #include <vector>
@@ -8,6 +13,8 @@
 #include <cstdint>
 #include <bitset>
 #include <cassert>
+#include <string>
+#include <cstdlib>
 
 // == For testing ==
 std::default_random_engine gen;
@@ -17,383 +24,282 @@ std::uniform_int_distribution<int> randColorRed(0,255);
 std::uniform_int_distribution<int> randColorGreen(0,255);
 std::uniform_int_distribution<int> randColorBlue(0,255);
 
-class Component;
-class EntityManager;
-class Entity;
-
-
-// == COMPONENT ID SYSTEM ==
-using ComponentID = std::uint32_t;
-constexpr std::size_t maxComponents{32};
-
-// == group variables ==
-using GroupID = std::uint32_t;
-constexpr std::uint32_t maxGroups{32};
-using GroupBitset = std::bitset<maxGroups>;
-
-using ComponentBitset = std::bitset<maxComponents>;
-using ComponentArray = std::array<Component*, maxComponents>;
-
-inline ComponentID genUComponentID() noexcept
-{
-    // generate a unique id for a component 
-    // (this gets called in the getComponentTypeID function -> when Entity::addComponent() is called)
-    static ComponentID lastID{0u};
-    return lastID++;
-}
-
-template<typename T> inline ComponentID getComponentTypeID() noexcept
-{
-    // for each unique component type, the template will be instanciated
-    // only once for each type of component thus, creating a unique ID
-
-    // make sure getComponentTypeID only gets called with 'T' that inherits from the Component class
-    // (std::is_base_of provides ::value = TRUE if the derived is part of the given base class)
-    static_assert(std::is_base_of<Component, T>::value && "ERROR: T must inherit from base Component class.");
-    static ComponentID typeID{genUComponentID()};
-
-    // subsequent calls with the same component type will return the same ID
-    return typeID;
-}
-
-
-// == BASE COMPONENT CLASS ==
-class Component
-{
-public:
-Entity* mEntity{nullptr};
-
-// for any component that is dependant on other component types
-// (makes composition easiers)
-virtual void initComponent() {}
-
-Component() {}
-virtual ~Component() {}
-
-void setOwnership(Entity* eOwner)
+// == COMPONENTS ==
+struct CounterComponent : Component
 {
-    this->mEntity = eOwner;
-}
-
-virtual void updateComponent(const float& dt) {}
-virtual void renderComponent(sf::RenderWindow& targetWin) {}
-
+    float counter;
+    void updateComponent(const float& dt) override
+    {
+        counter += dt;
+        //std::cout << counter << std::endl;
+    }
 };
 
-
-// == ENTITY CLASS ==
-class Entity
-{
-private:
-
-EntityManager& mManager;
-
-bool mAlive{true};
-std::vector<std::unique_ptr<Component>> mComponentsContainer {};
-
-ComponentArray mComponentArray {}; // stores the component pointer
-ComponentBitset mComponentBitset {}; // stores the ID of a particular component
-
-GroupBitset mGroupBitset {};
-
-public:
-// == CONSTRUCTOR/DESTRUCTOR ==
-Entity(EntityManager& manager) : mManager{manager} {}
-~Entity() {}
-
-template<typename T> bool hasComponent() const
-{
-    // check if entity possesses a component of type 'T'
-    // (bitset returns the value (true/false) of given index, which happens to be the unique ID)
-    return mComponentBitset[getComponentTypeID<T>()];
-}
-
-// takes in T(specified component type) <T>
-// takes in any amount of specified arguments that will be forwarded to the Component constructor <TArgs>
-template<typename T, typename... TArgs>
-T& addComponent(TArgs&&... mArgs)
-{
-    assert(!hasComponent<T>() && "ERROR: entity already owns this component.");
-
-    // 1. allocate new component of type <T>, 
-    T* component(new T(std::forward<TArgs>(mArgs)...));
-    // 2. components entity owner is set like so
-    component->setOwnership(this);
-    // 3. wrap the regular pointer into a smart pointer
-    std::unique_ptr<Component> uC_Ptr{component};
-    // 4. store the component smart_ptr in our container
-    mComponentsContainer.emplace_back(std::move(uC_Ptr));
-
-    // add a component of type 'T' at mComponentArray's index -> (unique ID) &
-    // set the component's bitset (depending on its unique ID)
-    mComponentArray[getComponentTypeID<T>()] = component;
-    mComponentBitset[getComponentTypeID<T>()] = true;
-
-    component->initComponent();
-    // return reference (so it's not lost to the container's ownership) to the component
-    return *component;
-}
-
-// == GROUP MANAGEMENT ==
-bool hasGroup(GroupID group) const noexcept
+// marks a falling shape, its look and position are kept in the entity's RenderQuad
+// (moved by moveShapes(), drawn by the QuadRenderer)
+struct ShapeComponent : Component
 {
-    return mGroupBitset[group];
-}
-
-void addGroup(GroupID group) noexcept;
+    const float getPos()
+    {
+        return mEntity->getComponent<RenderQuad>().mPosition.y;
+    }
+};
 
-void deleteGroup (GroupID group) noexcept
+struct KillComponent : Component
 {
-    mGroupBitset[group] = false;
-}
-
-
-// == accessor functions ==
-bool isAlive() const { return mAlive; }
-void destroyObj() { mAlive = false; }
+    CounterComponent* cCounter;
+    ShapeComponent* cShape;
 
-template<typename T> T& getComponent() const
-{
-    // retrieve pointer to given component of type 'T' from mComponentArray
-    assert(hasComponent<T>() && "ERROR: Component does not exist.");
-    auto ptr{mComponentArray[getComponentTypeID<T>()]};
-    return *static_cast<T*>(ptr);
-} 
-
-// == main loop functions == 
-void updateObj(const float& dt)
-{
-    for (auto& component : mComponentsContainer)
+    void initComponent() override
     {
-        component->updateComponent(dt);
+        cCounter = &mEntity->getComponent<CounterComponent>();
+        cShape = &mEntity->getComponent<ShapeComponent>();
     }
-}
 
-void renderObj(sf::RenderWindow& targetWin)
-{
-    for (auto& component : mComponentsContainer)
+    void updateComponent(const float& dt) override
     {
-        component->renderComponent(targetWin);
+        if(cCounter->counter >= 2) mEntity->destroyObj();
     }
-}
-
 };
 
-// == ENTITY MANAGER CLASS ==
-class EntityManager
+// == SNAPSHOT SERIALIZERS ==
+template<> struct ComponentSerializer<CounterComponent>
 {
-private:
-std::vector<std::unique_ptr<Entity>> mEntityContainer {};
-std::array<std::vector<Entity*>, maxGroups> mGroupedEntities {};
-
-public:
-EntityManager() {}
-~EntityManager() {}
+    static void write(BinaryWriter& out, const CounterComponent& c) { out.write(c.counter); }
+    static void read(BinaryReader& in, CounterComponent& c) { c.counter = in.read<float>(); }
+};
 
-Entity& addEntity()
+// ShapeComponent keeps no state of its own (its RenderQuad is a plain pooled column),
+// KillComponent only caches pointers to its siblings, those are re-resolved by initComponent()
+template<> struct ComponentSerializer<ShapeComponent>
 {
-    // 1. create new entity (add on the heap and assign pointer to it)
-    Entity* entity{new Entity{*this}};
-    // 2. wrap pure pointer into smart pointer
-    std::unique_ptr<Entity> uPtr{entity};
-    // 3. place smart pointer -> entity obj in container
-    mEntityContainer.emplace_back(std::move(uPtr));
+    static void write(BinaryWriter& out, const ShapeComponent& c) {}
+    static void read(BinaryReader& in, ShapeComponent& c) {}
+};
 
+template<> struct ComponentSerializer<KillComponent>
+{
+    static void write(BinaryWriter& out, const KillComponent& c) {}
+    static void read(BinaryReader& in, KillComponent& c) {}
+};
 
-    return *entity;
-}
 
-void addToGroup(Entity* entity, GroupID group)
+// == RESOURCES ==
+// NPCs spawn every 'mInterval' frames
+struct SpawnTimer
 {
-    mGroupedEntities[group].emplace_back(entity);
-}
+    float mElapsed{5.0f};
+    float mInterval{5.0f};
+};
 
-std::vector<Entity*>& getEntitiesByGroup(GroupID group)
+enum VOLEGroup : std::size_t
 {
-    return mGroupedEntities[group];
-}
+    Player,
+    NPC
+};
 
-// main loop functions
-void updateManager(const float& dt)
+// == SPAWNING ==
+// all entities created by the game loop go through here, so a replay can reissue them
+// (one prefab per group, built on first use)
+void spawnEntities(EntityManager& manager, VOLEGroup group, std::uint32_t count)
 {
-    for(auto i (0u); i < maxGroups; ++i)
-    {
-        auto& eV{mGroupedEntities[i]};
-
-        eV.erase
-        (std::remove_if(eV.begin(), eV.end(),
-        [i](Entity* entity)
-        {
-            return !entity->isAlive() || !entity->hasGroup(i);
-        }),
-        eV.end()); 
-    }
-
-    // remove all dead entities from mEntityContainer
-    // 1. we have an iterator return a value in removedEntity
-    // 2. using the lambda, it returns a dead entity into removedEntity
-    // 3. erase dead entity from container
-    mEntityContainer.erase
-    (std::remove_if(mEntityContainer.begin(), mEntityContainer.end(),
-    [](const std::unique_ptr<Entity>& entity)
-    {
-        return !entity->isAlive();
-    }
-    ),
-    mEntityContainer.end());
-
-    // update all entities in container
-    for(auto& entity : mEntityContainer)
+    static const std::array<Prefab, 2> prefabs
     {
-        entity->updateObj(dt);
-    }
-
-    //std::cout << "no. of entities: " << mEntityContainer.size() <<  std::endl;
-
-}
-
-void renderManager(sf::RenderWindow& targetWin)
-{
-    for(auto& entity : mEntityContainer)
+        Prefab{}.with<CounterComponent>().with<ShapeComponent>().with<KillComponent>()
+                .with<RenderQuad>(sf::Vector2f{}, sf::Vector2f(10.0f,10.0f)).inGroup(VOLEGroup::Player),
+        Prefab{}.with<CounterComponent>().with<ShapeComponent>().with<KillComponent>()
+                .with<RenderQuad>(sf::Vector2f{}, sf::Vector2f(10.0f,10.0f)).inGroup(VOLEGroup::NPC)
+    };
+    static std::vector<EntityID> spawned;
+    spawned.clear();
+    manager.instantiate(prefabs[group], count, &spawned);
+
+    // every shape gets its own color and position, drawn in spawn order
+    // (same draws in the same order as before, so recorded replays still match)
+    auto& quads{manager.getPool<RenderQuad>()};
+    for(auto id : spawned)
     {
-        entity->renderObj(targetWin);
+        sf::Color color(randColorRed(gen),randColorGreen(gen),randColorBlue(gen),255);
+        sf::Vector2f position(randPosx(gen),randPosy(gen));
+        auto& quad{quads.get(id)};
+        quad.mColor = color.toInteger();
+        quad.mPosition = position;
     }
 }
 
-};
-
-void Entity::addGroup(GroupID group) noexcept
+// == SYSTEMS ==
+// every shape falls at the same speed, one pass over the packed RenderQuad column
+void moveShapes(EntityManager& manager, float dt)
 {
-    mGroupBitset[group] = true;
-    mManager.addToGroup(this,group);
+    auto& quads{manager.getPool<RenderQuad>()};
+    auto* quad{quads.data()};
+    for(std::size_t i{0u}; i < quads.size(); ++i) quad[i].mPosition.y += 200.0f * dt;
 }
 
-// == COMPONENTS ==
-struct CounterComponent : Component
-{
-    float counter;
-    void updateComponent(const float& dt) override
-    {
-        counter += dt;
-        //std::cout << counter << std::endl;
-    }
-};
+// == REPLAY PLAYBACK ==
+// upper bound for a single recorded spawn, anything above comes from a corrupt file
+constexpr std::uint32_t maxReplaySpawnCount{4096u};
 
-struct ShapeComponent : Component
+// re-simulate a recorded session without a window, as fast as possible
+int playReplay(const std::string& path)
 {
-    sf::RectangleShape mShape;
-    ShapeComponent()
-    {
-        mShape.setFillColor(sf::Color(randColorRed(gen),randColorGreen(gen),randColorBlue(gen),255));
-        mShape.setSize(sf::Vector2f(10.0f,10.0f));
-        mShape.setPosition(randPosx(gen),randPosy(gen));
-    }
+    ReplayPlayer player;
+    if(!player.loadFromFile(path)) return 1;
 
-    const float getPos()
-    {
-        return mShape.getPosition().y;
-    }
-
-    void updateComponent(const float& dt)
-    {
-        mShape.move(0.0f, 200.0f * dt);
-    }
-
-    void renderComponent(sf::RenderWindow& targetWin) override
-    {
-        targetWin.draw(this->mShape);
-    }
-    
-};
+    gen.seed(player.getSeed());
 
-struct KillComponent : Component
-{
-    CounterComponent* cCounter;
-    ShapeComponent* cShape;
+    EntityManager manager;
+    ReplayTick tick;
+    sf::Clock clock;
+    std::uint32_t ticks{0u};
 
-    void initComponent() override
+    while(player.nextTick(tick))
     {
-        cCounter = &mEntity->getComponent<CounterComponent>();
-        cShape = &mEntity->getComponent<ShapeComponent>();
-    }
+        for(auto& spawn : tick.mSpawns)
+        {
+            // kinds and counts come from the file, the game only ever records its own groups, a few at a time
+            if(spawn.mKind > VOLEGroup::NPC || spawn.mCount > maxReplaySpawnCount)
+            {
+                std::cerr << "ERROR: replay spawns an unknown kind or too many entities after tick " << ticks << "." << std::endl;
+                return 1;
+            }
+            spawnEntities(manager, static_cast<VOLEGroup>(spawn.mKind), spawn.mCount);
+        }
 
-    void updateComponent(const float& dt) override
-    {
-        if(cCounter->counter >= 2) mEntity->destroyObj();
+        if(tick.mUpdated)
+        {
+            moveShapes(manager, tick.mDt);
+            manager.updateManager(tick.mDt);
+        }
+        ++ticks;
     }
-};
 
+    float elapsed{clock.getElapsedTime().asSeconds()};
+    std::cout << "replayed " << ticks << "/" << player.getTickCount() << " ticks in " << elapsed << "s ("
+              << ticks / elapsed << " ticks/s), " << manager.getEntityCount() << " entities left" << std::endl;
+    return ticks == player.getTickCount() ? 0 : 1;
+}
 
 
-int main()
+int main(int argc, char* argv[])
 {
-    enum VOLEGroup : std::size_t
+    // --record <file> logs the session, --replay <file> re-simulates one headlessly
+    // --telemetry <port> serves live metrics on localhost
+    std::string recordPath;
+    unsigned short telemetryPort{0u};
+    for(int i{1}; i + 1 < argc; ++i)
     {
-        Player,
-        NPC
-    };
+        std::string arg{argv[i]};
+        if(arg == "--replay") return playReplay(argv[i + 1]);
+        if(arg == "--record") recordPath = argv[i + 1];
+        if(arg == "--telemetry")
+        {
+            char* end{nullptr};
+            auto port{std::strtoul(argv[i + 1], &end, 10)};
+            if(end == argv[i + 1] || *end != '\0' || port == 0u || port > 65535u)
+            {
+                std::cerr << "ERROR: invalid telemetry port '" << argv[i + 1] << "'." << std::endl;
+                return 1;
+            }
+            telemetryPort = static_cast<unsigned short>(port);
+        }
+    }
 
     sf::RenderWindow mainWindow(sf::VideoMode(920,920),"ECS Test",sf::Style::Titlebar | sf::Style::Close);
     mainWindow.setFramerateLimit(120);
 
     sf::Clock clock;
     
-    float spawnTimerMax = 5.0f;
-    float spawnTimer = spawnTimerMax;
-    
     float UPS = 1.0f / 120.0f;
     float lastFrameTime = 0.0f;
     float dt = 0.0f;
 
     EntityManager manager;
 
+    // the seed is part of the replay, everything random must come from 'gen'
+    std::uint32_t seed{std::default_random_engine::default_seed};
+    gen.seed(seed);
+
+    ReplayRecorder recorder;
+    if(!recordPath.empty()) recorder.start(seed);
+
+    TelemetryMetrics metrics;
+    auto updateSystem{metrics.registerSystem("update")};
+    auto renderSystem{metrics.registerSystem("render")};
+    TelemetryServer telemetry{metrics};
+    if(telemetryPort != 0u && telemetry.listen(telemetryPort)) telemetry.start();
+
+    QuadRenderer quads;
+
+    manager.addResource<SpawnTimer>();
+    const auto spawnAccess{SystemAccess{}.writesResource<SpawnTimer>()};
+
+    auto spawn([&](VOLEGroup group, std::uint32_t count)
+    {
+        recorder.recordSpawn(group, count);
+        spawnEntities(manager, group, count);
+    });
+
     while(mainWindow.isOpen())
     {
         float currentFrameTime = clock.getElapsedTime().asSeconds();
         dt = currentFrameTime - lastFrameTime;
         lastFrameTime = currentFrameTime;
-        
-        auto& entity (manager.addEntity());
-        auto& cCounter(entity.addComponent<CounterComponent>());
-        auto& cShape(entity.addComponent<ShapeComponent>());
-        auto& cKill(entity.addComponent<KillComponent>());
+        metrics.recordFrame(dt);
 
-        entity.addGroup(VOLEGroup::Player);
-        
-
-        if(spawnTimer >= spawnTimerMax)
+        sf::Event ev;
+        while(mainWindow.pollEvent(ev))
         {
-            for(int i {0}; i < 1; ++i)
-            {
-                auto& entity(manager.addEntity());
-                auto& cCounter(entity.addComponent<CounterComponent>());
-                auto& cShape(entity.addComponent<ShapeComponent>());
-                auto& cKill(entity.addComponent<KillComponent>());
-
-                entity.addGroup(VOLEGroup::NPC);
-                
+            recorder.recordEvent(ev);
 
-                spawnTimer = 0.0f;
+            if(ev.type == sf::Event::Closed || (ev.type == sf::Event::KeyPressed && ev.key.code == sf::Keyboard::Escape))
+            {
+                mainWindow.close();
             }
         }
-        else
+        
         {
-            spawnTimer += 1.0f;
+            ScopedSystemAccess access{manager, spawnAccess};
+            spawn(VOLEGroup::Player, 1);
+
+            auto& timer{manager.resource<SpawnTimer>()};
+            if(timer.mElapsed >= timer.mInterval)
+            {
+                spawn(VOLEGroup::NPC, 1);
+                timer.mElapsed = 0.0f;
+            }
+            else
+            {
+                timer.mElapsed += 1.0f;
+            }
         }
 
         mainWindow.clear();
+        recorder.endTick(dt >= UPS, dt);
         if(dt >= UPS)
         {
+            ScopedSystemTimer timer{metrics, updateSystem};
+            moveShapes(manager, dt);
             manager.updateManager(dt);
             dt -= UPS;
         }
+        metrics.recordEntities(manager);
         
         auto& player(manager.getEntitiesByGroup(Player));
         auto& npcs(manager.getEntitiesByGroup(NPC));
 
         
-        manager.renderManager(mainWindow);
+        {
+            ScopedSystemTimer timer{metrics, renderSystem};
+            manager.renderManager(mainWindow);
+            quads.render(manager, mainWindow);
+        }
         mainWindow.display();
     }
+
+    if(recorder.isRecording() && !recorder.saveToFile(recordPath))
+    {
+        std::cerr << "ERROR: could not write replay '" << recordPath << "'." << std::endl;
+    }
     
 }